@@ -1,75 +1,142 @@
 /* TERALARM (FIRMWARE 3) - The effective alarm clock
 
-   BufferedLCD.cpp - The source file containing overrides for LCD class methods
-     which buffer the on-screen contents before sending to the hardware. Print
-     calls containing identical data to that in the buffer will not be resent
-     to the hardware, saving on overhead and reducing LCD flickers.
+   BufferedLCD.cpp - The source file containing the buffered LCD class, which
+     holds the on-screen contents in memory before sending them to the
+     hardware. Print calls write into a back buffer which is compared against
+     a front buffer mirroring the hardware, so that only the runs of
+     characters which have changed are sent, saving on overhead and reducing
+     LCD flickers. Numbers, aligned fields and scrolling marquees for strings
+     wider than their field are formatted straight into the buffer. Custom
+     characters are referenced by glyph IDs and cached in the 8 hardware
+     character slots, only being uploaded when a slot's contents change. The
+     class is a template over the LCD dimensions and the backend used to send
+     bytes to the hardware, so both buffers are statically allocated, all
+     position arithmetic is resolved at compile time and backend calls are
+     bound without virtual dispatch. BufferedLCD names the LCD used by the
+     firmware, with the dimensions and backend set in BufferedLCD.h.
      External Variables / Constants: N/A
      Third Party Includes:
        Arduino.h - The main Arduino library containing all platform specific
          functions and constants.
-       LiquidCrystal_I2C.h - Library used to interface with the LCD over the
-         I2C bus.
      Local Includes:
        BufferedLCD.h - Own header file.
+       PCF8574Backend.h - Backend for the HD44780 over a PCF8574 I2C backpack.
+       ParallelBackend.h - Backend for the HD44780 wired to GPIO pins.
 
    (C) RW128k 2024
 */
 
 #include "BufferedLCD.h"
 
-BufferedLCD::BufferedLCD(uint8_t addr, uint8_t cols, uint8_t rows, uint8_t charsize)
-: LiquidCrystal_I2C(addr, cols, rows, charsize) {
-  /* Constructor which first calls base LCD class constructor with passed
-       arguments and initialises instance variables. A character buffer is
-       dynamically allocated with the size matching the total number of
-       characters present on the hardware LCD. The buffer is filled with
-       whitespace characters, as the LCD will be initially empty. The size of
-       the LCD is recorded and the cursor is set to the first character.
-       Parameters:
-         addr - A byte representing the I2C address of the LCD.
-         cols - A byte representing the number of characters the LCD device has
-           horizontally.
-         rows - A byte representing the number of characters the LCD device has
-           vertically.
-         charsize - A byte representing the pixel dimensions of each character
-            on the LCD. See symbolic constants defined in LCD library for
-            accepted values.
-  */
-
-  buffer = new char[cols * rows];
-  memset(buffer, ' ', cols*rows);
-  maxX = cols;
-  maxY = rows;
+// number of whitespace characters separating the end of a scrolling string
+// from its start as it wraps around
+#define scrollGap 3
+
+// first byte of each frame streamed over Serial by the mirror
+#define mirrorMarker 0xFE
+
+// storage for the compile time LCD dimensions
+template <uint8_t Cols, uint8_t Rows, class Backend> constexpr uint8_t BasicBufferedLCD<Cols, Rows, Backend>::maxX;
+template <uint8_t Cols, uint8_t Rows, class Backend> constexpr uint8_t BasicBufferedLCD<Cols, Rows, Backend>::maxY;
+
+template <uint8_t Cols, uint8_t Rows, class Backend>
+BasicBufferedLCD<Cols, Rows, Backend>::BasicBufferedLCD(const Backend &backend)
+: Backend(backend) {
+  /* Constructor which first copies the passed backend (which holds the
+       hardware configuration) and initialises instance variables. Two
+       character buffers are held within the object with the size matching
+       the total number of characters present on the hardware LCD, given by
+       the template dimensions: the back buffer which is written by print calls and the
+       front buffer which mirrors the contents of the hardware. Both buffers
+       are filled with whitespace characters, as the LCD will be initially
+       empty. The cursor is set to the first character, the hardware cursor
+       position is marked as unknown and prints are sent immediately until a
+       frame is begun. No glyph table is set and all custom character slots
+       are marked as empty. The copy of the screen held by the Serial mirror
+       receiver is also blank.
+       Parameters:
+         backend - The display backend used to send bytes to the hardware,
+           configured for an LCD matching the template dimensions.
+  */
+
+  memset(buffer, ' ', maxX*maxY);
+  memset(screen, ' ', maxX*maxY);
   cursor = 0;
+  hardwareCursor = 0xFF;
+  frame = false;
+  dirty = false;
+  glyphTable = NULL;
+  memset(slotGlyph, 0, sizeof(slotGlyph));
+  flushCount = 0;
+  partialGlyph = 0;
+#if lcdMirror
+  memset(remote, ' ', maxX*maxY);
+  mirrorPending = false;
+#endif
 }
 
-BufferedLCD::~BufferedLCD() {
-  /* Destructor which simply frees the character buffer allocated within the
-       constructor.
+template <uint8_t Cols, uint8_t Rows, class Backend>
+void BasicBufferedLCD<Cols, Rows, Backend>::begin() {
+  /* begin - Method which has the backend initialise the hardware, which also
+       clears it, so both buffers are filled with whitespace to match. The
+       hardware cursor position is marked as unknown, as the initialisation
+       sequence leaves it undefined, as are the contents of the custom
+       character slots.
+       Parameters: N/A
+       Returns: N/A
   */
 
-  delete[] buffer;
+  this->beginDisplay();
+  memset(buffer, ' ', maxX*maxY);
+  memset(screen, ' ', maxX*maxY);
+  memset(slotGlyph, 0, sizeof(slotGlyph));
+  partialGlyph = 0;
+  hardwareCursor = 0xFF;
+  dirty = false;
 }
 
-void BufferedLCD::clear() {
-  /* clear - Method which first calls the base method to trigger the LCD clear
-       on the hardware, then fills the buffer with whitespace to match the now
-       empty LCD.
+template <uint8_t Cols, uint8_t Rows, class Backend>
+void BasicBufferedLCD<Cols, Rows, Backend>::clear() {
+  /* clear - Method which fills the back buffer with whitespace and begins a
+       frame, without sending the slow clear instruction to the hardware. The
+       screen drawn after clearing is composed in the frame so that the next
+       flush only sends the characters which differ between the old and new
+       screens, leaving any shared static text untouched and avoiding a blank
+       flicker. The caller must flush once the new screen has been composed.
        Parameters: N/A
        Returns: N/A
   */
 
-  LiquidCrystal_I2C::clear();
   memset(buffer, ' ', maxX*maxY);
+  dirty = true;
+  frame = true;
+}
+
+template <uint8_t Cols, uint8_t Rows, class Backend>
+void BasicBufferedLCD<Cols, Rows, Backend>::setGlyphs(const uint8_t *const *table) {
+  /* setGlyphs - Method which sets the table of custom characters that may be
+       printed by glyph ID. Glyph IDs are the control characters 0x01 -> 0x07
+       and 0x10 -> 0x1F, which can be placed in any printed string. Up to 8
+       different glyphs may be on screen at once. They are uploaded to the
+       hardware character slots as they are flushed, replacing the least
+       recently used glyphs which are no longer on screen.
+       Parameters:
+         table - A pointer to an array of 32 pointers in program memory, indexed
+           by glyph ID, each pointing to an array of 8 bytes in program memory
+           representing the rows of the glyph. Unused IDs should be NULL.
+       Returns: N/A
+  */
+
+  glyphTable = table;
 }
 
-void BufferedLCD::setCursor(uint8_t x, uint8_t y) {
-  /* setCursor - Method which sets the position on the LCD where characters are
-       to be printed. Checks that the passed coordinates are within range of
-       the LCD size specified in the constructor, then calls the base setCursor
-       method to set the cursor on the hardware and updates the cursor position
-       instance variable to the corresponding buffer index.
+template <uint8_t Cols, uint8_t Rows, class Backend>
+void BasicBufferedLCD<Cols, Rows, Backend>::setCursor(uint8_t x, uint8_t y) {
+  /* setCursor - Method which sets the position in the buffer where characters
+       are to be printed. Checks that the passed coordinates are within range
+       of the LCD size specified by the template, then updates the cursor
+       position instance variable to the corresponding buffer index. The
+       hardware cursor is only positioned when a changed run is flushed.
        Parameters:
          x - A byte representing the column number of the character to position
            the cursor at. Should be in range 0 -> maxX - 1.
@@ -79,21 +146,19 @@ void BufferedLCD::setCursor(uint8_t x, uint8_t y) {
   */
 
   if (x < maxX && y < maxY) {
-    LiquidCrystal_I2C::setCursor(x, y);
     cursor = (y * maxX) + x;
   }
 }
 
-void BufferedLCD::print(const __FlashStringHelper *string) {
-  /* print - Method which prints the passed string on the LCD at the current
-       cursor position if it differs from the existing contents. First checks
+template <uint8_t Cols, uint8_t Rows, class Backend>
+void BasicBufferedLCD<Cols, Rows, Backend>::print(const __FlashStringHelper *string) {
+  /* print - Method which writes the passed string into the back buffer at the
+       current cursor position and advances the cursor past it. First checks
        that there is sufficient space for the string at the current position
        and that the string differs to the current contents of the buffer at
-       that position. The base print method is then called to send the string
-       to the hardware and the buffer is updated to reflect the new LCD
-       contents. If the passed string is identical to the buffer contents at
-       the current position, or if it will exceed the size of the LCD if
-       printed at that position, the hardware print will not be invoked and the
+       that position, marking the buffer as dirty if so. Unless a frame has
+       been begun, the changes are flushed to the hardware immediately. If the
+       string will exceed the size of the LCD if printed at that position, the
        buffer will remain unchanged. As the string exists in program memory,
        the appropriate AVR _P functions are used and the pointer cast to the
        required type for use with these functions.
@@ -105,22 +170,24 @@ void BufferedLCD::print(const __FlashStringHelper *string) {
 
   const char *flashString = reinterpret_cast<const char *>(string);
   size_t length = strlen_P(flashString);
-  if (cursor + length <= maxX * maxY && memcmp_P(buffer + cursor, flashString, length)) {
-    LiquidCrystal_I2C::print(string);
+  if (cursor + length > maxX * maxY) {return;}
+  if (memcmp_P(buffer + cursor, flashString, length)) {
     memcpy_P(buffer + cursor, flashString, length);
+    dirty = true;
   }
+  cursor += length;
+  if (!frame) {flush();}
 }
 
-void BufferedLCD::print(const char *string) {
-  /* print - Method which prints the passed string on the LCD at the current
-       cursor position if it differs from the existing contents. First checks
+template <uint8_t Cols, uint8_t Rows, class Backend>
+void BasicBufferedLCD<Cols, Rows, Backend>::print(const char *string) {
+  /* print - Method which writes the passed string into the back buffer at the
+       current cursor position and advances the cursor past it. First checks
        that there is sufficient space for the string at the current position
        and that the string differs to the current contents of the buffer at
-       that position. The base print method is then called to send the string
-       to the hardware and the buffer is updated to reflect the new LCD
-       contents. If the passed string is identical to the buffer contents at
-       the current position, or if it will exceed the size of the LCD if
-       printed at that position, the hardware print will not be invoked and the
+       that position, marking the buffer as dirty if so. Unless a frame has
+       been begun, the changes are flushed to the hardware immediately. If the
+       string will exceed the size of the LCD if printed at that position, the
        buffer will remain unchanged.
        Parameters:
          string - A pointer to the character string to be printed on the LCD at
@@ -129,8 +196,678 @@ void BufferedLCD::print(const char *string) {
   */
 
   size_t length = strlen(string);
-  if (cursor + length <= maxX * maxY && memcmp(buffer + cursor, string, length)) {
-    LiquidCrystal_I2C::print(string);
+  if (cursor + length > maxX * maxY) {return;}
+  if (memcmp(buffer + cursor, string, length)) {
     memcpy(buffer + cursor, string, length);
+    dirty = true;
+  }
+  cursor += length;
+  if (!frame) {flush();}
+}
+
+template <uint8_t Cols, uint8_t Rows, class Backend>
+void BasicBufferedLCD<Cols, Rows, Backend>::print(char character) {
+  /* print - Method which writes a single character into the back buffer at the
+       current cursor position and advances the cursor past it. Unless a frame
+       has been begun, the change is flushed to the hardware immediately.
+       Parameters:
+         character - The character to be printed on the LCD at the current
+           cursor position.
+       Returns: N/A
+  */
+
+  put(character);
+  if (!frame) {flush();}
+}
+
+template <uint8_t Cols, uint8_t Rows, class Backend>
+void BasicBufferedLCD<Cols, Rows, Backend>::printPadded(const __FlashStringHelper *string, uint8_t width) {
+  /* printPadded - Method which writes the passed string into a field of the
+       specified width at the current cursor position, left aligned and padded
+       with whitespace to fill the field. Strings longer than the field are
+       truncated. The cursor is advanced past the field.
+       Parameters:
+         string - A pointer to the character string stored in program memory to
+           be printed on the LCD at the current cursor position.
+         width - A byte representing the number of characters in the field.
+       Returns: N/A
+  */
+
+  printField(reinterpret_cast<const char *>(string), true, width, 0);
+}
+
+template <uint8_t Cols, uint8_t Rows, class Backend>
+void BasicBufferedLCD<Cols, Rows, Backend>::printPadded(const char *string, uint8_t width) {
+  /* printPadded - Method which writes the passed string into a field of the
+       specified width at the current cursor position, left aligned and padded
+       with whitespace to fill the field. Strings longer than the field are
+       truncated. The cursor is advanced past the field.
+       Parameters:
+         string - A pointer to the character string to be printed on the LCD at
+           the current cursor position.
+         width - A byte representing the number of characters in the field.
+       Returns: N/A
+  */
+
+  printField(string, false, width, 0);
+}
+
+template <uint8_t Cols, uint8_t Rows, class Backend>
+void BasicBufferedLCD<Cols, Rows, Backend>::printCentered(const __FlashStringHelper *string, uint8_t width) {
+  /* printCentered - Method which writes the passed string centrally into a
+       field of the specified width at the current cursor position, padding
+       either side with whitespace. Where the string cannot be exactly
+       centred, it is placed one character to the left. Strings longer than
+       the field are truncated. The cursor is advanced past the field.
+       Parameters:
+         string - A pointer to the character string stored in program memory to
+           be printed on the LCD at the current cursor position.
+         width - A byte representing the number of characters in the field.
+       Returns: N/A
+  */
+
+  printField(reinterpret_cast<const char *>(string), true, width, 1);
+}
+
+template <uint8_t Cols, uint8_t Rows, class Backend>
+void BasicBufferedLCD<Cols, Rows, Backend>::printCentered(const char *string, uint8_t width) {
+  /* printCentered - Method which writes the passed string centrally into a
+       field of the specified width at the current cursor position, padding
+       either side with whitespace. Where the string cannot be exactly
+       centred, it is placed one character to the left. Strings longer than
+       the field are truncated. The cursor is advanced past the field.
+       Parameters:
+         string - A pointer to the character string to be printed on the LCD at
+           the current cursor position.
+         width - A byte representing the number of characters in the field.
+       Returns: N/A
+  */
+
+  printField(string, false, width, 1);
+}
+
+template <uint8_t Cols, uint8_t Rows, class Backend>
+void BasicBufferedLCD<Cols, Rows, Backend>::printRightAligned(const __FlashStringHelper *string, uint8_t width) {
+  /* printRightAligned - Method which writes the passed string into a field of
+       the specified width at the current cursor position, right aligned and
+       preceded by whitespace to fill the field. Strings longer than the field
+       are truncated. The cursor is advanced past the field.
+       Parameters:
+         string - A pointer to the character string stored in program memory to
+           be printed on the LCD at the current cursor position.
+         width - A byte representing the number of characters in the field.
+       Returns: N/A
+  */
+
+  printField(reinterpret_cast<const char *>(string), true, width, 2);
+}
+
+template <uint8_t Cols, uint8_t Rows, class Backend>
+void BasicBufferedLCD<Cols, Rows, Backend>::printRightAligned(const char *string, uint8_t width) {
+  /* printRightAligned - Method which writes the passed string into a field of
+       the specified width at the current cursor position, right aligned and
+       preceded by whitespace to fill the field. Strings longer than the field
+       are truncated. The cursor is advanced past the field.
+       Parameters:
+         string - A pointer to the character string to be printed on the LCD at
+           the current cursor position.
+         width - A byte representing the number of characters in the field.
+       Returns: N/A
+  */
+
+  printField(string, false, width, 2);
+}
+
+template <uint8_t Cols, uint8_t Rows, class Backend>
+void BasicBufferedLCD<Cols, Rows, Backend>::printScrolling(const __FlashStringHelper *string, uint8_t width, uint16_t step) {
+  /* printScrolling - Method which writes the passed string into a field of
+       the specified width at the current cursor position as a marquee.
+       Strings which fit the field are left aligned and padded with
+       whitespace, while longer strings are shown as a window into the string
+       which has been scrolled left by the passed number of steps, wrapping
+       around to the start after a gap. The cursor is advanced past the field.
+       Parameters:
+         string - A pointer to the character string stored in program memory to
+           be printed on the LCD at the current cursor position.
+         width - A byte representing the number of characters in the field.
+         step - An integer representing the number of characters the string
+           has been scrolled by (usually incremented on every redraw).
+       Returns: N/A
+  */
+
+  scrollField(reinterpret_cast<const char *>(string), true, width, step);
+}
+
+template <uint8_t Cols, uint8_t Rows, class Backend>
+void BasicBufferedLCD<Cols, Rows, Backend>::printScrolling(const char *string, uint8_t width, uint16_t step) {
+  /* printScrolling - Method which writes the passed string into a field of
+       the specified width at the current cursor position as a marquee.
+       Strings which fit the field are left aligned and padded with
+       whitespace, while longer strings are shown as a window into the string
+       which has been scrolled left by the passed number of steps, wrapping
+       around to the start after a gap. The cursor is advanced past the field.
+       Parameters:
+         string - A pointer to the character string to be printed on the LCD at
+           the current cursor position.
+         width - A byte representing the number of characters in the field.
+         step - An integer representing the number of characters the string
+           has been scrolled by (usually incremented on every redraw).
+       Returns: N/A
+  */
+
+  scrollField(string, false, width, step);
+}
+
+template <uint8_t Cols, uint8_t Rows, class Backend>
+void BasicBufferedLCD<Cols, Rows, Backend>::printUInt(unsigned long value, uint8_t width, bool zeroPad) {
+  /* printUInt - Method which writes the decimal digits of the passed number
+       straight into the back buffer at the current cursor position, without
+       formatting into an intermediate string. If the number has fewer digits
+       than the specified width, it is right aligned and preceded by zeros or
+       whitespace. The digits are written from the least significant end
+       backwards, so no reversal is needed. The cursor is advanced past the
+       number and, unless a frame has been begun, the changes are flushed to
+       the hardware immediately.
+       Parameters:
+         value - An unsigned integer to be printed on the LCD.
+         width - A byte representing the minimum number of characters to
+           occupy. Numbers with more digits are printed in full. Defaults to 0
+           which prints the number with no padding.
+         zeroPad - A boolean which is true to pad with zeros (eg 07) and false
+           to pad with whitespace. Defaults to false.
+       Returns: N/A
+  */
+
+  // count digits of value (at least 1 for zero)
+  uint8_t length = 1;
+  for (unsigned long rest = value / 10; rest > 0; rest /= 10) {length++;}
+
+  // pad up to the requested width
+  for (uint8_t i = length; i < width; i++) {put(zeroPad ? '0' : ' ');}
+
+  // place digits right to left, skipping any which fall beyond the LCD
+  size_t end = cursor + length;
+  for (size_t pos = end; pos-- > cursor;) {
+    char digit = '0' + (value % 10);
+    value /= 10;
+    if (pos < maxX * maxY && buffer[pos] != digit) {
+      buffer[pos] = digit;
+      dirty = true;
+    }
+  }
+  cursor = end;
+
+  if (!frame) {flush();}
+}
+
+template <uint8_t Cols, uint8_t Rows, class Backend>
+void BasicBufferedLCD<Cols, Rows, Backend>::fill(char character, uint8_t count) {
+  /* fill - Method which writes the passed character repeatedly into the back
+       buffer from the current cursor position, advancing the cursor past
+       them. Useful for progress bars and blinking cursors.
+       Parameters:
+         character - The character to be repeated on the LCD.
+         count - A byte representing the number of times to repeat it.
+       Returns: N/A
+  */
+
+  for (uint8_t i = 0; i < count; i++) {put(character);}
+  if (!frame) {flush();}
+}
+
+template <uint8_t Cols, uint8_t Rows, class Backend>
+void BasicBufferedLCD<Cols, Rows, Backend>::padTo(uint8_t x) {
+  /* padTo - Method which writes whitespace into the back buffer from the
+       current cursor position up to (but not including) the specified column
+       of the current row, advancing the cursor to that column. Nothing is
+       written if the cursor is already at or past the column. Used to blank
+       the remainder of a field or row after variable length content.
+       Parameters:
+         x - A byte representing the column number to pad up to. Should be in
+           range 0 -> maxX, where maxX pads to the end of the row.
+       Returns: N/A
+  */
+
+  size_t end = cursor - (cursor % maxX) + x;
+  while (cursor < end) {put(' ');}
+  if (!frame) {flush();}
+}
+
+template <uint8_t Cols, uint8_t Rows, class Backend>
+void BasicBufferedLCD<Cols, Rows, Backend>::beginFrame() {
+  /* beginFrame - Method which enters frame mode, where subsequent print calls
+       only write into the back buffer and nothing is sent to the hardware
+       until flush is called. Allows an entire screen to be composed before
+       the changed runs across all prints are sent together.
+       Parameters: N/A
+       Returns: N/A
+  */
+
+  frame = true;
+}
+
+template <uint8_t Cols, uint8_t Rows, class Backend>
+void BasicBufferedLCD<Cols, Rows, Backend>::flush() {
+  /* flush - Method which sends the differences between the back buffer and
+       the front buffer (hardware contents) to the LCD and leaves frame mode.
+       Waits until every changed character has been sent, including any left
+       pending by flushLater. Nothing is scanned if the back buffer is
+       unchanged since the last flush.
+       Parameters: N/A
+       Returns: N/A
+  */
+
+  frame = false;
+  if (dirty) {sendRuns(false);}
+}
+
+template <uint8_t Cols, uint8_t Rows, class Backend>
+void BasicBufferedLCD<Cols, Rows, Backend>::flushLater() {
+  /* flushLater - Method which leaves frame mode without sending anything to
+       the hardware, leaving the changed characters pending to be sent a
+       single backend transfer (eg I2C transmission) at a time by service.
+       Allows large repaints to be interleaved with polling the buttons rather
+       than blocking for the whole transfer.
+       Parameters: N/A
+       Returns: N/A
+  */
+
+  frame = false;
+}
+
+template <uint8_t Cols, uint8_t Rows, class Backend>
+void BasicBufferedLCD<Cols, Rows, Backend>::service() {
+  /* service - Method which sends the next pending changes to the LCD, filling
+       at most one backend transfer (BUFFER_LENGTH bytes for I2C), so each
+       call blocks for a few milliseconds at most. Does nothing while a frame
+       is being composed, so a half drawn screen is never sent. Should be
+       called on every iteration of a loop which uses flushLater.
+       Parameters: N/A
+       Returns: N/A
+  */
+
+  if (dirty && !frame) {sendRuns(true);}
+
+  // catch up the Serial mirror, which may lag behind the hardware
+  mirror();
+}
+
+template <uint8_t Cols, uint8_t Rows, class Backend>
+void BasicBufferedLCD<Cols, Rows, Backend>::sendRuns(bool single) {
+  /* sendRuns - Method which sends the differences between the back and front
+       buffers to the LCD. Each row is walked for runs of consecutive
+       characters which differ, and each run is sent with a single hardware
+       cursor command followed by its characters, before being copied to the
+       front buffer. Rows are walked separately as the hardware does not
+       address consecutive rows contiguously. The cursor command is skipped
+       when a run begins at the address the hardware cursor was
+       auto-incremented to by the previous run. All runs are packed into as few
+       backend transfers as possible. Any glyphs in the back buffer which are
+       not already held in a custom character slot are uploaded first, and
+       glyph IDs are translated to their slots as they are sent. Glyphs which
+       cannot be shown are recorded in the front buffer as the whitespace sent
+       in their place, so they are retried on the next flush after the back
+       buffer changes (a slot only frees when a glyph leaves the buffer, so
+       they are not retried before then). When limited to a single transfer,
+       sending stops at the first byte for which the backend has no room
+       (including glyph uploads, with no characters sent until every upload is
+       complete) and the buffers are left marked as changed. The changes sent
+       are then passed on to the Serial mirror.
+       Parameters:
+         single - Boolean which is true to send at most one transfer.
+       Returns: N/A
+  */
+
+  this->beginTransfer();
+  bool full = !loadGlyphs(single);
+
+  for (uint8_t y = 0; y < maxY && !full; y++) {
+    char *back = buffer + (y * maxX);
+    char *front = screen + (y * maxX);
+    uint8_t x = 0;
+
+    while (x < maxX && !full) {
+      // skip characters already present on the hardware
+      if (back[x] == front[x]) {
+        x++;
+        continue;
+      }
+
+      // stop if there is no room for a cursor command and the first character
+      if (single && this->transferRoom() < 2) {
+        full = true;
+        break;
+      }
+
+      // position hardware cursor only if it is not already at the run
+      uint8_t start = x;
+      uint8_t runAddress = address(start, y);
+      if (runAddress != hardwareCursor) {this->transferByte(0x80 | runAddress, false);}
+
+      // send run until the next unchanged character, end of row or until the
+      // transfer is full, mirroring it in front buffer as it was shown
+      while (x < maxX && back[x] != front[x]) {
+        if (single && this->transferRoom() < 1) {
+          full = true;
+          break;
+        }
+        uint8_t code = glyphCode(back[x]);
+        this->transferByte(code, true);
+        front[x] = code == ' ' ? ' ' : back[x];
+        x++;
+      }
+
+      // track the auto-incremented hardware cursor, following the wrap from
+      // the end of each half of display memory to the start of the other
+      hardwareCursor = runAddress + (x - start);
+      if (hardwareCursor >= 0x68) {
+        hardwareCursor -= 0x68;
+      } else if (hardwareCursor >= 0x28 && hardwareCursor < 0x40) {
+        hardwareCursor += 0x18;
+      }
+    }
+  }
+
+  this->endTransfer();
+  dirty = full;
+
+#if lcdMirror
+  mirrorPending = true;
+#endif
+  mirror();
+}
+
+template <uint8_t Cols, uint8_t Rows, class Backend>
+void BasicBufferedLCD<Cols, Rows, Backend>::mirror() {
+  /* mirror - Method which streams the differences between the front buffer
+       (hardware contents) and the copy of the screen held by the receiver
+       over Serial when lcdMirror is set. Each row is walked for runs of
+       characters which differ as in sendRuns, and each run is written as a
+       frame with a 3 byte header. Only as much as fits in the free space of
+       the Serial transmit buffer is written, so the call never waits for the
+       UART, and the rest is sent on a later call (from service or the next
+       send to the LCD). Runs cut short by a full buffer continue from where
+       they stopped. Does nothing when lcdMirror is not set.
+       Parameters: N/A
+       Returns: N/A
+  */
+
+#if lcdMirror
+  if (!mirrorPending) {return;}
+
+  for (uint8_t y = 0; y < maxY; y++) {
+    char *front = screen + (y * maxX);
+    char *copy = remote + (y * maxX);
+    uint8_t x = 0;
+
+    while (x < maxX) {
+      // skip characters the receiver already holds
+      if (front[x] == copy[x]) {
+        x++;
+        continue;
+      }
+
+      // stop if there is no room for the header and the first character,
+      // leaving the rest pending
+      int room = Serial.availableForWrite() - 3;
+      if (room < 1) {return;}
+
+      // find the end of the run, limited to the free space
+      uint8_t start = x;
+      while (x < maxX && front[x] != copy[x] && x - start < room) {x++;}
+
+      // write the frame and mirror it in the receiver's copy
+      Serial.write(mirrorMarker);
+      Serial.write((y << 5) | start);
+      Serial.write(x - start);
+      Serial.write((const uint8_t *) front + start, x - start);
+      memcpy(copy + start, front + start, x - start);
+    }
+  }
+
+  mirrorPending = false;
+#endif
+}
+
+template <uint8_t Cols, uint8_t Rows, class Backend>
+constexpr uint8_t BasicBufferedLCD<Cols, Rows, Backend>::address(uint8_t x, uint8_t y) {
+  /* address - Method which calculates the hardware display memory address of
+       the character at the passed coordinates. Odd rows are stored in the
+       second half of display memory (from 0x40) and the third and fourth rows
+       continue on from the end of the first and second rows respectively.
+       Parameters:
+         x - A byte representing the column number of the character.
+         y - A byte representing the row number of the character.
+       Returns: A byte representing the display memory address of the
+         character.
+  */
+
+  return (y & 0x1 ? 0x40 : 0x00) + (y & 0x2 ? maxX : 0) + x;
+}
+
+template <uint8_t Cols, uint8_t Rows, class Backend>
+void BasicBufferedLCD<Cols, Rows, Backend>::put(char character) {
+  /* put - Method which writes a single character into the back buffer at the
+       current cursor position, marking the buffer as dirty if it differs, and
+       advances the cursor. Characters beyond the end of the LCD are discarded.
+       Nothing is flushed, as this is the building block of the public print
+       methods which flush once their entire field has been written.
+       Parameters:
+         character - The character to be written to the buffer.
+       Returns: N/A
+  */
+
+  if (cursor < maxX * maxY && buffer[cursor] != character) {
+    buffer[cursor] = character;
+    dirty = true;
+  }
+  cursor++;
+}
+
+template <uint8_t Cols, uint8_t Rows, class Backend>
+void BasicBufferedLCD<Cols, Rows, Backend>::printField(const char *string, bool progmem, uint8_t width, uint8_t align) {
+  /* printField - Method which writes the passed string into a field of the
+       specified width at the current cursor position, filling the remainder
+       of the field with whitespace according to the alignment. Strings longer
+       than the field are truncated. Shared implementation of the padded,
+       centred and right aligned print methods.
+       Parameters:
+         string - A pointer to the character string to be printed on the LCD.
+         progmem - A boolean which is true when the string exists in program
+           memory and must be read with the AVR _P functions.
+         width - A byte representing the number of characters in the field.
+         align - A byte which is 0 for left, 1 for centre and 2 for right
+           alignment.
+       Returns: N/A
+  */
+
+  // measure string, truncating to the field
+  size_t length = progmem ? strlen_P(string) : strlen(string);
+  if (length > width) {length = width;}
+
+  // calculate whitespace before string based on alignment
+  uint8_t before = align == 0 ? 0 : align == 1 ? (width - length) / 2 : width - length;
+
+  // write leading whitespace, string and trailing whitespace
+  for (uint8_t i = 0; i < before; i++) {put(' ');}
+  for (size_t i = 0; i < length; i++) {put(progmem ? pgm_read_byte(string + i) : string[i]);}
+  for (uint8_t i = before + length; i < width; i++) {put(' ');}
+
+  if (!frame) {flush();}
+}
+
+template <uint8_t Cols, uint8_t Rows, class Backend>
+void BasicBufferedLCD<Cols, Rows, Backend>::scrollField(const char *string, bool progmem, uint8_t width, uint16_t step) {
+  /* scrollField - Method which writes a window of the passed string into a
+       field of the specified width at the current cursor position. Only the
+       back buffer is rewritten, so when flushed the hardware receives just
+       the cells whose character differs from the previous step rather than
+       the entire field. Shared implementation of the scrolling print methods.
+       Parameters:
+         string - A pointer to the character string to be printed on the LCD.
+         progmem - A boolean which is true when the string exists in program
+           memory and must be read with the AVR _P functions.
+         width - A byte representing the number of characters in the field.
+         step - An integer representing the number of characters the string
+           has been scrolled by.
+       Returns: N/A
+  */
+
+  // strings which fit the field do not need to scroll
+  size_t length = progmem ? strlen_P(string) : strlen(string);
+  if (length <= width) {
+    printField(string, progmem, width, 0);
+    return;
+  }
+
+  // write the window starting at the scrolled position, treating the string
+  // and its trailing gap as a loop
+  size_t period = length + scrollGap;
+  size_t index = step % period;
+  for (uint8_t i = 0; i < width; i++) {
+    put(index >= length ? ' ' : progmem ? pgm_read_byte(string + index) : string[index]);
+    if (++index == period) {index = 0;}
+  }
+
+  if (!frame) {flush();}
+}
+
+template <uint8_t Cols, uint8_t Rows, class Backend>
+bool BasicBufferedLCD<Cols, Rows, Backend>::loadGlyphs(bool single) {
+  /* loadGlyphs - Method which ensures every glyph in the back buffer is held
+       in a custom character slot, packing any uploads into the open backend
+       transfer. Glyphs already held in a slot are marked as used by this
+       flush. Each missing glyph is uploaded to an empty slot, or failing that
+       to the least recently used slot whose glyph is no longer in the back
+       buffer, so glyphs still on screen are never replaced. Glyphs which
+       cannot be given a slot (more than 8 on screen) or which are not in the
+       glyph table are not uploaded and will be shown as whitespace. When
+       limited to a single transfer, an upload which does not fit is stopped
+       part way and resumed from the same row by the next call, its slot
+       being left empty until the whole bitmap has been sent.
+       Parameters:
+         single - Boolean which is true to stop once the open transfer is full.
+       Returns: Boolean which is true if every glyph which can be uploaded is
+         held in a slot, false if the transfer filled up first.
+  */
+
+  // collect the set of glyph IDs in the back buffer
+  uint32_t needed = 0;
+  for (uint8_t i = 0; i < maxX * maxY; i++) {
+    if (buffer[i] > 0 && buffer[i] < 0x20) {needed |= 1UL << buffer[i];}
+  }
+
+  // abandon a part uploaded glyph which has left the buffer, leaving its slot
+  // empty
+  if (((needed >> partialGlyph) & 0x1) == 0) {partialGlyph = 0;}
+  if (needed == 0) {return true;}
+
+  // mark held glyphs as used, leaving only those missing from the slots
+  flushCount++;
+  uint32_t missing = needed;
+  for (uint8_t slot = 0; slot < 8; slot++) {
+    if (slotGlyph[slot] != 0 && (needed >> slotGlyph[slot]) & 0x1) {
+      slotUsed[slot] = flushCount;
+      missing &= ~(1UL << slotGlyph[slot]);
+    }
+  }
+
+  // finish a part uploaded glyph first, so its slot is not given to another
+  if (partialGlyph != 0) {
+    missing &= ~(1UL << partialGlyph);
+    const uint8_t *bitmap = reinterpret_cast<const uint8_t *>(pgm_read_ptr(glyphTable + partialGlyph));
+    if (!uploadGlyph(partialGlyph, bitmap, partialSlot, partialRow, single)) {return false;}
+  }
+
+  for (char id = 1; id < 0x20 && missing != 0; id++) {
+    if (((missing >> id) & 0x1) == 0) {continue;}
+    missing &= ~(1UL << id);
+
+    // skip glyphs which do not exist in the table
+    const uint8_t *bitmap = glyphTable == NULL ? NULL : reinterpret_cast<const uint8_t *>(pgm_read_ptr(glyphTable + id));
+    if (bitmap == NULL) {continue;}
+
+    // find an empty slot, or the least recently used slot not in the buffer
+    uint8_t victim = 8;
+    for (uint8_t slot = 0; slot < 8; slot++) {
+      if (slotGlyph[slot] == 0) {
+        victim = slot;
+        break;
+      }
+      if ((needed >> slotGlyph[slot]) & 0x1) {continue;}
+      if (victim == 8 || uint16_t(flushCount - slotUsed[slot]) > uint16_t(flushCount - slotUsed[victim])) {victim = slot;}
+    }
+    if (victim == 8) {continue;}
+
+    if (!uploadGlyph(id, bitmap, victim, 0, single)) {return false;}
+  }
+
+  return true;
+}
+
+template <uint8_t Cols, uint8_t Rows, class Backend>
+bool BasicBufferedLCD<Cols, Rows, Backend>::uploadGlyph(char id, const uint8_t *bitmap, uint8_t slot, uint8_t row, bool single) {
+  /* uploadGlyph - Method which uploads the rows of a glyph's bitmap to a
+       custom character slot, starting from the given row, leaving the
+       hardware addressing character memory. The slot is left empty while
+       only part of the bitmap has been sent, and the progress is recorded so
+       that the upload can be resumed.
+       Parameters:
+         id - The glyph ID being uploaded.
+         bitmap - A pointer to the 8 rows of the glyph in program memory.
+         slot - A byte representing the custom character slot (0 -> 7).
+         row - A byte representing the first row to send (0 -> 7).
+         single - Boolean which is true to stop once the open transfer is full.
+       Returns: Boolean which is true if the whole bitmap has been sent, false
+         if the transfer filled up first.
+  */
+
+  slotGlyph[slot] = 0;
+  partialGlyph = id;
+  partialSlot = slot;
+  partialRow = row;
+  if (single && this->transferRoom() < 2) {return false;}
+
+  // address the first row to send, then send rows while there is room
+  this->transferByte(0x40 | (slot << 3) | row, false);
+  hardwareCursor = 0xFF;
+  for (; row < 8; row++) {
+    if (single && this->transferRoom() < 1) {
+      partialRow = row;
+      return false;
+    }
+    this->transferByte(pgm_read_byte(bitmap + row), true);
+  }
+
+  slotGlyph[slot] = id;
+  slotUsed[slot] = flushCount;
+  partialGlyph = 0;
+  return true;
+}
+
+template <uint8_t Cols, uint8_t Rows, class Backend>
+uint8_t BasicBufferedLCD<Cols, Rows, Backend>::glyphCode(char id) {
+  /* glyphCode - Method which translates a character from the buffer to the
+       character code sent to the hardware. Regular characters are unchanged,
+       while glyph IDs are translated to the code of the slot holding them.
+       Codes 0x08 -> 0x0F are used for slots 0 -> 7 as these mirror codes
+       0x00 -> 0x07 in the hardware, avoiding the null character.
+       Parameters:
+         id - The character from the buffer to translate.
+       Returns: A byte representing the character code to send to the LCD, or
+         whitespace for glyphs not held in a slot.
+  */
+
+  if (id <= 0 || id >= 0x20) {return id;}
+  for (uint8_t slot = 0; slot < 8; slot++) {
+    if (slotGlyph[slot] == id) {return 0x08 + slot;}
   }
+  return ' ';
 }
+
+// instantiate the LCD dimensions and backend used by the firmware
+#if lcdParallel
+template class BasicBufferedLCD<lcdCols, lcdRows, ParallelBackend>;
+#else
+template class BasicBufferedLCD<lcdCols, lcdRows, PCF8574Backend>;
+#endif
@@ -1,17 +1,45 @@
 /* TERALARM (FIRMWARE 3) - The effective alarm clock
 
-   BufferedLCD.h - The header file containing overrides for LCD class methods
-     which buffer the on-screen contents before sending to the hardware. Print
-     calls containing identical data to that in the buffer will not be resent
-     to the hardware, saving on overhead and reducing LCD flickers.
+   BufferedLCD.h - The header file containing the buffered LCD class, which
+     holds the on-screen contents in memory before sending them to the
+     hardware. Print calls write into a back buffer which is compared against
+     a front buffer mirroring the hardware, so that only the runs of
+     characters which have changed are sent, saving on overhead and reducing
+     LCD flickers. Numbers, aligned fields and scrolling marquees for strings
+     wider than their field are formatted straight into the buffer. Custom
+     characters are referenced by glyph IDs and cached in the 8 hardware
+     character slots, only being uploaded when a slot's contents change.
+     Frames may also be left pending and sent a single transfer at a time from
+     a polling loop, so large repaints do not block user input. The class is
+     a template over the LCD dimensions and a backend policy, which the class
+     inherits from so that its public methods (eg I2C statistics) are
+     available on the LCD object. A backend must provide:
+       beginDisplay() - Initialise (and clear) the hardware.
+       beginTransfer() / endTransfer() - Open and send a batch of bytes.
+       transferByte(value, data) - Add an instruction or character byte.
+       transferRoom() - Number of bytes which fit in the open batch.
+     When lcdMirror is set, the contents of the hardware are also streamed
+     over Serial as frames holding only the runs of characters which changed,
+     sent as room frees up in the Serial transmit buffer so the loop is never
+     blocked. Each frame is:
+       0xFE - Frame marker.
+       (row << 5) | column - Position of the first character of the run.
+       length - Number of characters in the run (1 - columns).
+       characters - The run, with custom characters sent as their glyph IDs.
+     The receiver starts from a blank screen, as the LCD does after begin, and
+     can resynchronise on the marker. tools/lcdMirror.py decodes the stream.
+     BufferedLCD names the LCD used by the firmware (20x4 unless lcdCols and
+     lcdRows are changed), on a PCF8574 I2C backpack or wired directly to
+     GPIO pins when lcdParallel is set. Its dimensions are public as maxX and
+     maxY for laying out screens.
      External Variables / Constants: N/A
      Third Party Includes:
        Arduino.h - The main Arduino library containing all platform specific
          functions and constants.
-       LiquidCrystal_I2C.h - Library used to interface with the LCD over the
-         I2C bus.
      Local Includes:
        BufferedLCD.h - Own header file.
+       PCF8574Backend.h - Backend for the HD44780 over a PCF8574 I2C backpack.
+       ParallelBackend.h - Backend for the HD44780 wired to GPIO pins.
 
    (C) RW128k 2024
 */
@@ -20,24 +48,94 @@
 #define BUFFEREDLCD_H
 
 #include <Arduino.h>
-#include <LiquidCrystal_I2C.h>
 
-class BufferedLCD : private LiquidCrystal_I2C {
+#include "PCF8574Backend.h"
+#include "ParallelBackend.h"
+
+// set to 1 to drive the LCD directly over 6 GPIO pins (see teralarm.ino)
+// instead of through the I2C backpack. may also be set by the build
+#ifndef lcdParallel
+#define lcdParallel 0
+#endif
+
+// dimensions of the LCD in characters. screens are laid out to fit (see
+// screenLayout.h). may also be set by the build (eg -DlcdCols=16 -DlcdRows=2
+// for the host harness)
+#ifndef lcdCols
+#define lcdCols 20
+#endif
+#ifndef lcdRows
+#define lcdRows 4
+#endif
+
+// set to 1 to stream changes to the LCD over Serial (see above), which must
+// be started before the LCD
+#define lcdMirror 0
+
+template <uint8_t Cols, uint8_t Rows, class Backend>
+class BasicBufferedLCD : public Backend {
 public:
-    BufferedLCD(uint8_t addr, uint8_t cols, uint8_t rows, uint8_t charsize = 0);
-    ~BufferedLCD();
-    using LiquidCrystal_I2C::begin;
+    static constexpr uint8_t maxX = Cols;
+    static constexpr uint8_t maxY = Rows;
+
+    BasicBufferedLCD(const Backend &backend);
+    void begin();
     void clear();
-    using LiquidCrystal_I2C::createChar;
+    void setGlyphs(const uint8_t *const *table);
     void setCursor(uint8_t x, uint8_t y);
     void print(const __FlashStringHelper *string);
     void print(const char *string);
+    void print(char character);
+    void printPadded(const __FlashStringHelper *string, uint8_t width);
+    void printPadded(const char *string, uint8_t width);
+    void printCentered(const __FlashStringHelper *string, uint8_t width);
+    void printCentered(const char *string, uint8_t width);
+    void printRightAligned(const __FlashStringHelper *string, uint8_t width);
+    void printRightAligned(const char *string, uint8_t width);
+    void printScrolling(const __FlashStringHelper *string, uint8_t width, uint16_t step);
+    void printScrolling(const char *string, uint8_t width, uint16_t step);
+    void printUInt(unsigned long value, uint8_t width = 0, bool zeroPad = false);
+    void fill(char character, uint8_t count);
+    void padTo(uint8_t x);
+    void beginFrame();
+    void flush();
+    void flushLater();
+    void service();
 
 private:
-    char *buffer;
-    uint8_t maxX;
-    uint8_t maxY;
+    static constexpr uint8_t address(uint8_t x, uint8_t y);
+    void put(char character);
+    void printField(const char *string, bool progmem, uint8_t width, uint8_t align);
+    void scrollField(const char *string, bool progmem, uint8_t width, uint16_t step);
+    void sendRuns(bool single);
+    void mirror();
+    bool loadGlyphs(bool single);
+    bool uploadGlyph(char id, const uint8_t *bitmap, uint8_t slot, uint8_t row, bool single);
+    uint8_t glyphCode(char id);
+
+    char buffer[Cols * Rows];
+    char screen[Cols * Rows];
     size_t cursor;
+    uint8_t hardwareCursor;
+    const uint8_t *const *glyphTable;
+    char slotGlyph[8];
+    uint16_t slotUsed[8];
+    char partialGlyph;
+    uint8_t partialSlot;
+    uint8_t partialRow;
+    uint16_t flushCount;
+    bool frame;
+    bool dirty;
+#if lcdMirror
+    char remote[Cols * Rows];
+    bool mirrorPending;
+#endif
 };
 
+#if lcdParallel
+typedef BasicBufferedLCD<lcdCols, lcdRows, ParallelBackend> BufferedLCD;
+#else
+typedef BasicBufferedLCD<lcdCols, lcdRows, PCF8574Backend> BufferedLCD;
+#endif
+
 #endif
@@ -0,0 +1,312 @@
+/* TERALARM (FIRMWARE 3) - The effective alarm clock
+
+   PCF8574Backend.cpp - The source file containing the display backend which
+     drives an HD44780 LCD in 4 bit mode through a PCF8574 I2C backpack. Bytes
+     for the LCD are packed into as few Wire transmissions as possible, the
+     LCD is initialised by polling the busy flag and the traffic sent is
+     counted so the bus time spent on rendering can be measured on the device.
+     External Variables / Constants: N/A
+     Third Party Includes:
+       Arduino.h - The main Arduino library containing all platform specific
+         functions and constants.
+       LiquidCrystal_I2C.h - Library used to initialise the LCD over the I2C
+         bus with fixed delays when the busy flag cannot be read.
+       Wire.h - Arduino library used to send batched transmissions to the LCD
+         I2C backpack.
+     Local Includes:
+       PCF8574Backend.h - Own header file.
+
+   (C) RW128k 2024
+*/
+
+#include <Wire.h>
+
+#include "PCF8574Backend.h"
+
+// PCF8574 backpack pin assignments: register select, read/write, enable and
+// backlight on the low bits with the HD44780 data nibble on the high bits
+#define pcfRS 0x01
+#define pcfRW 0x02
+#define pcfEnable 0x04
+#define pcfBacklight 0x08
+
+// I2C clock the Wire library starts the bus at
+#define defaultClock 100000
+
+// longest time an HD44780 instruction may take (clear display) before the
+// busy flag is considered stuck
+#define busyTimeoutMicros 3000
+
+PCF8574Backend::PCF8574Backend(uint8_t addr, uint8_t cols, uint8_t rows, uint8_t charsize)
+: LiquidCrystal_I2C(addr, cols, rows, charsize) {
+  /* Constructor which first calls base LCD class constructor with passed
+       arguments (used only when falling back to its initialisation) and
+       initialises instance variables. The I2C address of the LCD is recorded
+       and the traffic counters are zeroed, assuming the bus runs at the
+       default clock. The function set instruction used to initialise the
+       hardware is derived from the number of rows and character size.
+       Parameters:
+         addr - A byte representing the I2C address of the LCD.
+         cols - A byte representing the number of characters the LCD device has
+           horizontally.
+         rows - A byte representing the number of characters the LCD device has
+           vertically.
+         charsize - A byte representing the pixel dimensions of each character
+            on the LCD. See symbolic constants defined in LCD library for
+            accepted values.
+  */
+
+  i2cAddress = addr;
+  transferLength = 0;
+  transferMode = 0xFF;
+  transactionCount = 0;
+  byteCount = 0;
+  busMicros = 0;
+  errorCount = 0;
+  bitNanos = 1000000000UL / defaultClock;
+  functionSet = 0x20 | (rows > 1 ? 0x08 : 0x00) | (charsize != 0 && rows == 1 ? 0x04 : 0x00);
+}
+
+void PCF8574Backend::beginDisplay() {
+  /* beginDisplay - Method which initialises the hardware, which also clears
+       it. The instructions following the switch to 4 bit mode wait on the
+       busy flag read back from the LCD rather than fixed worst case delays.
+       If the busy flag cannot be read (eg backpacks with the read/write line
+       tied low), the base method is called to initialise the hardware with
+       fixed delays instead.
+       Parameters: N/A
+       Returns: N/A
+  */
+
+  Wire.begin();
+  if (!initialise()) {LiquidCrystal_I2C::begin();}
+}
+
+void PCF8574Backend::setClock(uint32_t clock) {
+  /* setClock - Method which sets the clock frequency of the I2C bus shared
+       with the backpack and records it for estimating the bus time of later
+       transmissions. Must be called after the display has begun, which resets
+       the bus to the default clock. Character and cursor instructions still
+       need no delays at 400kHz, where each nibble takes at least 2 bytes
+       (45us) to latch.
+       Parameters:
+         clock - An unsigned long representing the clock frequency in Hz.
+       Returns: N/A
+  */
+
+  Wire.setClock(clock);
+  bitNanos = 1000000000UL / clock;
+}
+
+unsigned long PCF8574Backend::i2cTransactions() {
+  /* i2cTransactions - Method which gets the number of I2C transmissions sent
+       to the backpack by flushes since the object was constructed. Traffic
+       from the hardware initialisation is not counted.
+       Parameters: N/A
+       Returns: An unsigned long representing the number of transmissions.
+  */
+
+  return transactionCount;
+}
+
+unsigned long PCF8574Backend::i2cBytes() {
+  /* i2cBytes - Method which gets the number of bytes sent over the I2C bus by
+       flushes since the object was constructed, including the address byte
+       which opens each transmission.
+       Parameters: N/A
+       Returns: An unsigned long representing the number of bytes.
+  */
+
+  return byteCount;
+}
+
+unsigned long PCF8574Backend::i2cMicros() {
+  /* i2cMicros - Method which estimates the time the I2C bus has been occupied
+       by flushes since the object was constructed. Each byte takes 9 clock
+       cycles (8 data bits and an acknowledge) on top of the start and stop
+       conditions of each transmission, at the clock set when it was sent.
+       Parameters: N/A
+       Returns: An unsigned long representing the bus time in microseconds.
+  */
+
+  return busMicros;
+}
+
+unsigned long PCF8574Backend::i2cErrors() {
+  /* i2cErrors - Method which gets the number of I2C transmissions sent by
+       flushes which failed (eg not acknowledged or timed out) since the
+       object was constructed.
+       Parameters: N/A
+       Returns: An unsigned long representing the number of failures.
+  */
+
+  return errorCount;
+}
+
+void PCF8574Backend::beginTransfer() {
+  /* beginTransfer - Method which opens an I2C transmission to the backpack,
+       into which bytes for the LCD are packed by transferByte until
+       endTransfer is called.
+       Parameters: N/A
+       Returns: N/A
+  */
+
+  Wire.beginTransmission(i2cAddress);
+  transferLength = 0;
+  transferMode = 0xFF;
+}
+
+void PCF8574Backend::transferByte(uint8_t value, bool data) {
+  /* transferByte - Method which packs the backpack writes needed to send a
+       byte to the LCD in 4 bit mode into the open I2C transmission. Each
+       nibble is placed on the data lines with the enable line high, then
+       latched by bringing the enable line low. When the register select mode
+       changes, it is first set with the enable line low so that it is stable
+       before the next enable pulse. Once the Wire buffer cannot hold another
+       nibble, the transmission is sent and a new one opened. The time taken to
+       clock each byte over the bus exceeds the execution time of character
+       and cursor instructions (even at 400kHz), so no further delays are
+       required.
+       Parameters:
+         value - A byte representing the character or instruction to send.
+         data - Boolean which is true for character data, false for
+           instructions.
+       Returns: N/A
+  */
+
+  // send enable pulse for both nibbles, high nibble first
+  uint8_t mode = data ? pcfRS : 0;
+  uint8_t nibbles[2] = {uint8_t(value & 0xF0), uint8_t(value << 4)};
+  for (byte i = 0; i < 2; i++) {
+    // start new transmission if there is no room for a setup write and pulse
+    if (transferLength + 3 > BUFFER_LENGTH) {
+      endTransfer();
+      Wire.beginTransmission(i2cAddress);
+      transferLength = 0;
+    }
+
+    // settle register select before pulse if mode has changed
+    if (mode != transferMode) {
+      Wire.write(mode | pcfBacklight);
+      transferMode = mode;
+      transferLength++;
+    }
+
+    Wire.write(nibbles[i] | mode | pcfBacklight | pcfEnable);
+    Wire.write(nibbles[i] | mode | pcfBacklight);
+    transferLength += 2;
+  }
+}
+
+void PCF8574Backend::endTransfer() {
+  /* endTransfer - Method which sends the remaining packed bytes of the open
+       I2C transmission to the backpack and adds it to the traffic counters,
+       counting it as an error if the backpack did not acknowledge it.
+       Parameters: N/A
+       Returns: N/A
+  */
+
+  if (Wire.endTransmission() != 0) {errorCount++;}
+  transactionCount++;
+  byteCount += transferLength + 1;
+  busMicros += ((transferLength + 1) * 9UL + 2) * bitNanos / 1000;
+}
+
+uint8_t PCF8574Backend::transferRoom() {
+  /* transferRoom - Method which calculates how many more bytes can be sent to
+       the LCD in the open I2C transmission before it must be split, allowing
+       for a register select setup write before each.
+       Parameters: N/A
+       Returns: A byte representing the number of bytes which will fit.
+  */
+
+  return (BUFFER_LENGTH - transferLength) / 5;
+}
+
+bool PCF8574Backend::initialise() {
+  /* initialise - Method which runs the HD44780 initialisation sequence using
+       the busy flag. The controller is first reset into 8 bit mode with three
+       function set nibbles separated by the fixed delays from the datasheet
+       (the busy flag cannot be read until the interface width is known), then
+       switched to 4 bit mode. Every following instruction (function set,
+       display on, clear and entry mode) is sent as soon as the busy flag
+       shows the previous one has completed.
+       Parameters: N/A
+       Returns: Boolean which is true if the busy flag could be read after
+         every instruction, false if the sequence was abandoned.
+  */
+
+  // wait for the supply to rise after power on, then reset into 8 bit mode
+  delay(50);
+  writeNibble(0x30);
+  delayMicroseconds(4500);
+  writeNibble(0x30);
+  delayMicroseconds(150);
+  writeNibble(0x30);
+  delayMicroseconds(150);
+
+  // switch to 4 bit mode, after which full instructions can be sent
+  writeNibble(0x20);
+  if (!waitReady()) {return false;}
+
+  // set lines and font, turn display on with no cursor, clear and set the
+  // cursor to increment after each character
+  const uint8_t instructions[4] = {functionSet, 0x0C, 0x01, 0x06};
+  for (uint8_t i = 0; i < 4; i++) {
+    writeNibble(instructions[i] & 0xF0);
+    writeNibble(instructions[i] << 4);
+    if (!waitReady()) {return false;}
+  }
+  return true;
+}
+
+void PCF8574Backend::writeNibble(uint8_t nibble) {
+  /* writeNibble - Method which sends a single instruction nibble to the LCD
+       in its own I2C transmission, by placing it on the data lines and
+       pulsing the enable line.
+       Parameters:
+         nibble - A byte holding the nibble to send in its upper 4 bits.
+       Returns: N/A
+  */
+
+  Wire.beginTransmission(i2cAddress);
+  Wire.write(nibble | pcfBacklight | pcfEnable);
+  Wire.write(nibble | pcfBacklight);
+  Wire.endTransmission();
+}
+
+bool PCF8574Backend::waitReady() {
+  /* waitReady - Method which polls the HD44780 busy flag until the last
+       instruction has completed. The data lines of the PCF8574 are released
+       by writing them high with the read/write line set, so the LCD can drive
+       them while the enable line is high. The upper nibble (holding the busy
+       flag) is read back during the first enable pulse and a second pulse
+       completes the 4 bit read.
+       Parameters: N/A
+       Returns: Boolean which is true once the LCD is ready, false if the
+         backpack did not respond or the busy flag stayed set for longer than
+         any instruction can take.
+  */
+
+  unsigned long start = micros();
+  while (micros() - start < busyTimeoutMicros) {
+    // raise enable with the data lines released to read the upper nibble
+    Wire.beginTransmission(i2cAddress);
+    Wire.write(0xF0 | pcfRW | pcfBacklight);
+    Wire.write(0xF0 | pcfRW | pcfBacklight | pcfEnable);
+    if (Wire.endTransmission() != 0) {return false;}
+    if (Wire.requestFrom(i2cAddress, uint8_t(1)) != 1) {return false;}
+    uint8_t upper = Wire.read();
+
+    // finish the read with a pulse for the lower nibble and return to write
+    Wire.beginTransmission(i2cAddress);
+    Wire.write(0xF0 | pcfRW | pcfBacklight);
+    Wire.write(0xF0 | pcfRW | pcfBacklight | pcfEnable);
+    Wire.write(0xF0 | pcfRW | pcfBacklight);
+    Wire.write(pcfBacklight);
+    if (Wire.endTransmission() != 0) {return false;}
+
+    if (!(upper & 0x80)) {return true;}
+  }
+  return false;
+}
@@ -0,0 +1,60 @@
+/* TERALARM (FIRMWARE 3) - The effective alarm clock
+
+   PCF8574Backend.h - The header file containing the display backend which
+     drives an HD44780 LCD in 4 bit mode through a PCF8574 I2C backpack. Bytes
+     for the LCD are packed into as few Wire transmissions as possible, the
+     LCD is initialised by polling the busy flag and the traffic sent is
+     counted so the bus time spent on rendering can be measured on the device.
+     External Variables / Constants: N/A
+     Third Party Includes:
+       Arduino.h - The main Arduino library containing all platform specific
+         functions and constants.
+       LiquidCrystal_I2C.h - Library used to initialise the LCD over the I2C
+         bus with fixed delays when the busy flag cannot be read.
+       Wire.h - Arduino library used to send batched transmissions to the LCD
+         I2C backpack.
+     Local Includes:
+       PCF8574Backend.h - Own header file.
+
+   (C) RW128k 2024
+*/
+
+#ifndef PCF8574BACKEND_H
+#define PCF8574BACKEND_H
+
+#include <Arduino.h>
+#include <LiquidCrystal_I2C.h>
+
+class PCF8574Backend : private LiquidCrystal_I2C {
+public:
+    PCF8574Backend(uint8_t addr, uint8_t cols, uint8_t rows, uint8_t charsize = 0);
+    void setClock(uint32_t clock);
+    unsigned long i2cTransactions();
+    unsigned long i2cBytes();
+    unsigned long i2cMicros();
+    unsigned long i2cErrors();
+
+protected:
+    void beginDisplay();
+    void beginTransfer();
+    void transferByte(uint8_t value, bool data);
+    void endTransfer();
+    uint8_t transferRoom();
+
+private:
+    bool initialise();
+    void writeNibble(uint8_t nibble);
+    bool waitReady();
+
+    uint8_t i2cAddress;
+    uint8_t transferLength;
+    uint8_t transferMode;
+    uint8_t functionSet;
+    unsigned long transactionCount;
+    unsigned long byteCount;
+    unsigned long busMicros;
+    unsigned long errorCount;
+    uint16_t bitNanos;
+};
+
+#endif
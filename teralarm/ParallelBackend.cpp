@@ -0,0 +1,174 @@
+/* TERALARM (FIRMWARE 3) - The effective alarm clock
+
+   ParallelBackend.cpp - The source file containing the display backend which
+     drives an HD44780 LCD directly in 4 bit mode over 6 GPIO pins (register
+     select, enable and 4 data lines, with read/write tied low). The port
+     register and bit mask of each pin are looked up once, so each nibble is
+     written with a handful of register operations rather than through
+     digitalWrite or a serial expander.
+     External Variables / Constants: N/A
+     Third Party Includes:
+       Arduino.h - The main Arduino library containing all platform specific
+         functions and constants.
+     Local Includes:
+       ParallelBackend.h - Own header file.
+
+   (C) RW128k 2024
+*/
+
+#include "ParallelBackend.h"
+
+// indexes of the pins in the pin, port and mask arrays
+#define pinRS 0
+#define pinEnable 1
+#define pinData 2
+
+// execution time of character and cursor instructions, and of clear display
+#define instructionMicros 40
+#define clearMicros 2000
+
+// number of bytes sent per transfer when sending a frame in the background
+#define batchLength 32
+
+ParallelBackend::ParallelBackend(uint8_t rs, uint8_t enable, uint8_t d4, uint8_t d5, uint8_t d6, uint8_t d7, uint8_t rows, uint8_t charsize) {
+  /* Constructor which records the pins the LCD is wired to, looking up the
+       output register and bit mask of each so they can be written directly.
+       The function set instruction used to initialise the hardware is
+       derived from the number of rows and character size.
+       Parameters:
+         rs - The pin connected to the LCD register select line.
+         enable - The pin connected to the LCD enable line.
+         d4 -> d7 - The pins connected to the upper 4 LCD data lines.
+         rows - A byte representing the number of characters the LCD device has
+           vertically.
+         charsize - A byte representing the pixel dimensions of each character
+            on the LCD (non zero for 5x10 on single line LCDs).
+  */
+
+  const uint8_t wiring[6] = {rs, enable, d4, d5, d6, d7};
+  for (uint8_t i = 0; i < 6; i++) {
+    pins[i] = wiring[i];
+    ports[i] = portOutputRegister(digitalPinToPort(wiring[i]));
+    masks[i] = digitalPinToBitMask(wiring[i]);
+  }
+  transferLength = 0;
+  functionSet = 0x20 | (rows > 1 ? 0x08 : 0x00) | (charsize != 0 && rows == 1 ? 0x04 : 0x00);
+}
+
+void ParallelBackend::beginDisplay() {
+  /* beginDisplay - Method which sets the LCD pins as outputs and initialises
+       the hardware, which also clears it. As the read/write line is tied low
+       the busy flag cannot be read, so the delays from the datasheet are
+       used throughout.
+       Parameters: N/A
+       Returns: N/A
+  */
+
+  for (uint8_t i = 0; i < 6; i++) {
+    pinMode(pins[i], OUTPUT);
+    writePin(ports[i], masks[i], false);
+  }
+
+  // wait for the supply to rise after power on, then reset into 8 bit mode
+  delay(50);
+  writeNibble(0x30);
+  delayMicroseconds(4500);
+  writeNibble(0x30);
+  delayMicroseconds(150);
+  writeNibble(0x30);
+  delayMicroseconds(150);
+
+  // switch to 4 bit mode, then set lines and font, turn display on with no
+  // cursor, clear and set the cursor to increment after each character
+  writeNibble(0x20);
+  delayMicroseconds(instructionMicros);
+  transferByte(functionSet, false);
+  transferByte(0x0C, false);
+  transferByte(0x01, false);
+  delayMicroseconds(clearMicros);
+  transferByte(0x06, false);
+}
+
+void ParallelBackend::beginTransfer() {
+  /* beginTransfer - Method which starts a new batch of bytes for the LCD. As
+       the pins are written directly, this only resets the batch length.
+       Parameters: N/A
+       Returns: N/A
+  */
+
+  transferLength = 0;
+}
+
+void ParallelBackend::transferByte(uint8_t value, bool data) {
+  /* transferByte - Method which sends a byte to the LCD in 4 bit mode, setting
+       the register select line then writing the upper and lower nibbles, and
+       waits for the instruction to execute.
+       Parameters:
+         value - A byte representing the character or instruction to send.
+         data - Boolean which is true for character data, false for
+           instructions.
+       Returns: N/A
+  */
+
+  writePin(ports[pinRS], masks[pinRS], data);
+  writeNibble(value & 0xF0);
+  writeNibble(value << 4);
+  delayMicroseconds(instructionMicros);
+  transferLength++;
+}
+
+void ParallelBackend::endTransfer() {
+  /* endTransfer - Method which ends a batch of bytes for the LCD. Nothing is
+       buffered, so there is nothing left to send.
+       Parameters: N/A
+       Returns: N/A
+  */
+}
+
+uint8_t ParallelBackend::transferRoom() {
+  /* transferRoom - Method which calculates how many more bytes may be sent in
+       the current batch, so a frame sent in the background is split into
+       batches taking around 1.5ms each.
+       Parameters: N/A
+       Returns: A byte representing the number of bytes which will fit.
+  */
+
+  return transferLength < batchLength ? batchLength - transferLength : 0;
+}
+
+void ParallelBackend::writeNibble(uint8_t nibble) {
+  /* writeNibble - Method which places a nibble on the 4 data lines and latches
+       it by pulsing the enable line. The enable line is held high for at
+       least 1us to satisfy the minimum pulse width.
+       Parameters:
+         nibble - A byte holding the nibble to send in its upper 4 bits.
+       Returns: N/A
+  */
+
+  for (uint8_t i = 0; i < 4; i++) {writePin(ports[pinData + i], masks[pinData + i], (nibble >> (4 + i)) & 0x1);}
+  writePin(ports[pinEnable], masks[pinEnable], true);
+  delayMicroseconds(1);
+  writePin(ports[pinEnable], masks[pinEnable], false);
+}
+
+void ParallelBackend::writePin(volatile uint8_t *port, uint8_t mask, bool high) {
+  /* writePin - Method which sets or clears a single bit of an output port
+       register. Interrupts are disabled during the read-modify-write, as other
+       pins on the same port (eg the buzzer driven by tone) may be written from
+       interrupt handlers.
+       Parameters:
+         port - Pointer to the output register of the port.
+         mask - A byte with the bit of the pin set.
+         high - Boolean which is true to drive the pin high.
+       Returns: N/A
+  */
+
+  uint8_t oldSREG = SREG;
+  cli();
+  if (high) {
+    *port |= mask;
+  } else {
+    *port &= ~mask;
+  }
+  SREG = oldSREG;
+}
@@ -0,0 +1,46 @@
+/* TERALARM (FIRMWARE 3) - The effective alarm clock
+
+   ParallelBackend.h - The header file containing the display backend which
+     drives an HD44780 LCD directly in 4 bit mode over 6 GPIO pins (register
+     select, enable and 4 data lines, with read/write tied low). The port
+     register and bit mask of each pin are looked up once, so each nibble is
+     written with a handful of register operations rather than through
+     digitalWrite or a serial expander.
+     External Variables / Constants: N/A
+     Third Party Includes:
+       Arduino.h - The main Arduino library containing all platform specific
+         functions and constants.
+     Local Includes:
+       ParallelBackend.h - Own header file.
+
+   (C) RW128k 2024
+*/
+
+#ifndef PARALLELBACKEND_H
+#define PARALLELBACKEND_H
+
+#include <Arduino.h>
+
+class ParallelBackend {
+public:
+    ParallelBackend(uint8_t rs, uint8_t enable, uint8_t d4, uint8_t d5, uint8_t d6, uint8_t d7, uint8_t rows, uint8_t charsize = 0);
+
+protected:
+    void beginDisplay();
+    void beginTransfer();
+    void transferByte(uint8_t value, bool data);
+    void endTransfer();
+    uint8_t transferRoom();
+
+private:
+    void writeNibble(uint8_t nibble);
+    static void writePin(volatile uint8_t *port, uint8_t mask, bool high);
+
+    uint8_t pins[6];
+    volatile uint8_t *ports[6];
+    uint8_t masks[6];
+    uint8_t transferLength;
+    uint8_t functionSet;
+};
+
+#endif
@@ -15,6 +15,9 @@
      Local Includes:
        extendedFunctionality.h - Provides function for debug mode, accessible
          via brightness UI.
+       busHealth.h - Monitors the I2C bus for failures.
+       screenLayout.h - Positions of the brightness screen elements.
+       screenWidgets.h - Draws the brightness screen as widgets.
        backgroundTasks.h - Own header file.
 
    (C) RW128k 2022
@@ -24,6 +27,9 @@
 #include <EEPROM.h>
 
 #include "extendedFunctionality.h"
+#include "busHealth.h"
+#include "screenLayout.h"
+#include "screenWidgets.h"
 #include "backgroundTasks.h"
 
 #define button1 2
@@ -36,6 +42,21 @@
 // file-scoped global to record currently tracking button
 static byte lastPressed = 0;
 
+// brightness screen: title and either the mode text (value 0) or the level
+// bar (value 1) between the bounds of the bar, the other being hidden
+static const char brightTitle[] PROGMEM = "BRIGHTNESS";
+static const char brightBoundL[] PROGMEM = "\2";
+static const char brightBoundR[] PROGMEM = "\4";
+static const char brightAuto[] PROGMEM = "AUTO";
+static const char *const brightModes[] PROGMEM = {brightAuto};
+static const Widget brightWidgets[] PROGMEM = {
+  {widgetLabel, brightTitleX, 0, 10, 0, brightTitle},
+  {widgetLabel, 1, brightBarY, 1, 0, brightBoundL},
+  {widgetText, 2, brightBarY, brightBarWidth, 0, brightModes},
+  {widgetBar, 2, brightBarY, brightBarWidth, 1, NULL},
+  {widgetLabel, brightBarWidth + 2, brightBarY, 1, 0, brightBoundR}
+};
+
 byte brightCurve(short sensor) {
   /* brightCurve - Function that converts a sensor value (usually read from the
        LDR) to a value suitable for writing to the LCD backlight to control
@@ -78,8 +99,11 @@ byte getPressed() {
         of state after 100ms to avoid debounce. Also records the highest and
         lowest light intensity values observed within 1 second and passes the
         average to the reciprocal brightness equation for setting automatic
-        brightness. This function should be called at every iteration of an
-        'infinite' loop to insure user input and brightness is not blocked.
+        brightness, and checks the I2C bus for failures once a second. Sends
+        the next pending LCD changes left by flushLater, one I2C transmission
+        per call. This function should be called at every iteration of an
+        'infinite' loop to insure user input, brightness and the LCD are not
+        blocked.
         Parameters: N/A
         Returns: Integer representing number of button pressed. 0 if no button
           is pressed or if number has already been returned by a prior call
@@ -92,6 +116,9 @@ byte getPressed() {
   static unsigned long brightTimer = millis();
   short curSensor = analogRead(ldr);
 
+  // send the next transmission of any LCD changes pending in the background
+  lcd.service();
+
   // initialise button press related variables
   static unsigned long pressTimer = 0;
   static bool hold = false;
@@ -103,9 +130,11 @@ byte getPressed() {
   if (curSensor > maxSensor) {maxSensor = curSensor;}
 
   // every second set the LCD brightness to the average light intensity if
-  // automatic brightness is enabled and reset boundaries and timer
+  // automatic brightness is enabled and reset boundaries and timer. the I2C
+  // bus is also checked for failures
   if (millis() - brightTimer >= 1000) {
     if (brightness == 0) {analogWrite(lcdLED, brightCurve((maxSensor + minSensor) / 2));}
+    checkBus();
     minSensor = 1024;
     maxSensor = 0;
     brightTimer = millis();
@@ -162,13 +191,16 @@ void consumePress() {
   lastPressed = 5;
 }
 
-bool updateBrightness() {
+bool updateBrightness(bool redraw) {
   /* updateBrightness - Function which sets the LCD backlight brightness to a
        value based on the global 'brightness' variable or on the current light
        intensity if automatic brightness (0) is set. Displays the brightness
        UI for 2 seconds, allowing the user to further increment/decrement the
        variable or access the debug mode by holding both buttons 1 and 2.
-       Parameters: N/A
+       Parameters:
+         redraw - Boolean which is true to draw the whole UI (on the first
+           call after the LCD has been cleared), otherwise only the widgets
+           whose values have changed since the last call are drawn.
        Returns: Boolean which is true when the user has changed the brightness
          so the UI needs to be redrawn and backlight updated. Avoids recursion
          by letting the caller handle redraws.
@@ -177,35 +209,32 @@ bool updateBrightness() {
   // store current brightness value in EEPROM
   EEPROM.update(6, brightness);
 
-  // set up LCD with UI title
-  lcd.setCursor(5, 0);
-  lcd.print(F("BRIGHTNESS"));
-
-  lcd.setCursor(1, 2);
-
-  // buffer for holding 'progress bar'
-  char bar[19];
+  // current values of the mode text and level bar widgets, one of which is
+  // hidden, and the values last drawn, kept between calls
+  byte values[2];
+  static byte drawn[2] = {0, 0};
 
-  // automatic brightness: set bar to reflect this and backlight based on light
+  // automatic brightness: show mode text and set backlight based on light
   if (brightness == 0) {
-    strcpy_P(bar, reinterpret_cast<const char *>(F("\2      AUTO      \4")));
+    values[0] = 0;
+    values[1] = widgetHidden;
     analogWrite(lcdLED, brightCurve(analogRead(ldr)));
   } else {
     // manual brightness: turn backlight off if brightness is 1 or use
     // reciprocal brightness equation to set it if between 2 and 17
     analogWrite(lcdLED, brightness == 1 ? 0 : brightCurve(41.3 * (brightness - 2) + 110));
 
-    // construct bar buffer with correct number of block characters
-    bar[0] = 2; // LEFT BOUND
-    bar[17] = 4; // RIGHT BOUND
-    bar[18] = 0; // NULL TERMINATOR
-    
-    memset(bar + 1, 3, brightness - 1); // POINTER ARITHMETIC!!!
-    memset(bar + brightness, ' ', 17 - brightness);
+    // show bar with correct number of block characters between bounds,
+    // scaled from the 16 manual levels to the width of the bar
+    values[0] = widgetHidden;
+    values[1] = (brightness - 1) * brightBarWidth / 16;
   }
 
-  // print bar to LCD - final UI element
-  lcd.print(bar);
+  // draw only the widgets whose values have changed (or the whole screen on
+  // the first call) as a single LCD frame and send it
+  lcd.beginFrame();
+  drawWidgets(brightWidgets, sizeof(brightWidgets) / sizeof(Widget), values, drawn, redraw);
+  lcd.flush();
 
   // wait for 2 seconds before returning false unless brightness is changed via
   // buttons 3 or 4 which returns true prematurely prompting redraw
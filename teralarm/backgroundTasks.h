@@ -32,6 +32,6 @@ byte brightCurve(short sensor);
 void background(unsigned short sleepDuration);
 byte getPressed();
 void consumePress();
-bool updateBrightness();
+bool updateBrightness(bool redraw);
 
 #endif
@@ -0,0 +1,145 @@
+/* TERALARM (FIRMWARE 3) - The effective alarm clock
+
+   busHealth.cpp - The source file containing functions which run the I2C bus
+     shared by the LCD and RTC in fast mode (400kHz) when both devices
+     support it, and monitor it for failed transmissions so that it can drop
+     back to standard mode (100kHz) automatically. Fast mode is opt in, as
+     the PCF8574 on the LCD backpack is only specified for 100kHz.
+     External Variables / Constants:
+       lcd - Hardware object representing LCD.
+     Third Party Includes:
+       Arduino.h - The main Arduino library containing all platform specific
+         functions and constants.
+       Wire.h - Arduino library used to set the bus clock and probe devices.
+     Local Includes:
+       busHealth.h - Own header file.
+       timeKeeping.h - Provides the count of failed RTC transactions.
+
+   (C) RW128k 2024
+*/
+
+#include <Arduino.h>
+#include <Wire.h>
+
+#include "busHealth.h"
+#include "timeKeeping.h"
+
+#define lcdAddress 0x27
+#define rtcAddress 0x68
+#define standardClock 100000
+#define fastClock 400000
+
+// set to 1 to run the bus at the fast clock. the PCF8574 on the LCD backpack
+// is only specified for 100kHz, and a probe being acknowledged does not prove
+// that data is written reliably, so fast mode is opt in and relies on the
+// checks below to fall back on parts which do not keep up
+#define fastMode 0
+
+// number of failed transmissions within a single check which drop the bus
+// back to the standard clock
+#define faultLimit 3
+
+// file-scoped globals to record the current bus clock and total failures
+static unsigned long clockSpeed = standardClock;
+static unsigned long faults = 0;
+
+static bool probe(byte address) {
+  /* probe - Function which checks that a device on the I2C bus responds by
+       sending an empty transmission to its address.
+       Parameters:
+         address - The 7 bit I2C address of the device.
+       Returns: Boolean which is true if the device acknowledged its address.
+  */
+
+  Wire.beginTransmission(address);
+  return Wire.endTransmission() == 0;
+}
+
+static void setBusClock(unsigned long clock) {
+  /* setBusClock - Function which sets the I2C clock for both the LCD (unless
+       it is wired directly) and RTC and records it.
+       Parameters:
+         clock - The clock frequency in Hz.
+       Returns: N/A
+  */
+
+  #if lcdParallel
+  Wire.setClock(clock);
+  #else
+  lcd.setClock(clock);
+  #endif
+  clockSpeed = clock;
+}
+
+void beginBus() {
+  /* beginBus - Function which sets up the I2C bus after the LCD and RTC have
+       been initialised (both of which reset it to the standard clock). A
+       timeout is set so that a device holding the bus cannot hang the
+       firmware. If fast mode is enabled the clock is raised and both devices
+       are probed, returning to the standard clock if either fails to respond.
+       Parameters: N/A
+       Returns: N/A
+  */
+
+  #ifdef WIRE_HAS_TIMEOUT
+  Wire.setWireTimeout(25000, true);
+  #endif
+
+  if (!fastMode) {return;}
+
+  setBusClock(fastClock);
+  if ((!lcdParallel && !probe(lcdAddress)) || !probe(rtcAddress)) {
+    faults++;
+    setBusClock(standardClock);
+  }
+}
+
+void checkBus() {
+  /* checkBus - Function which counts the failed transmissions since the last
+       call, from LCD flushes (including timeouts) and from the time service's
+       reads and writes of the RTC. The RTC is only probed once failures have
+       been seen, so that a quiet bus carries no extra traffic. The bus is
+       dropped to the standard clock for the rest of the session if too many
+       fail while in fast mode. Should be called periodically (once a second).
+       Parameters: N/A
+       Returns: N/A
+  */
+
+  // count new LCD (if it is on the bus) and RTC failures
+  unsigned long recent = 0;
+  #if !lcdParallel
+  static unsigned long lcdErrors = 0;
+  recent = lcd.i2cErrors() - lcdErrors;
+  lcdErrors = lcd.i2cErrors();
+  #endif
+  static unsigned long timeErrors = 0;
+  recent += rtcErrors() - timeErrors;
+  timeErrors = rtcErrors();
+
+  // probe the RTC only after failures, to tell whether the bus is still
+  // failing
+  if (recent > 0 && !probe(rtcAddress)) {recent++;}
+  faults += recent;
+
+  // fall back to the standard clock if the bus is unreliable
+  if (clockSpeed == fastClock && recent >= faultLimit) {setBusClock(standardClock);}
+}
+
+unsigned long busClock() {
+  /* busClock - Function which gets the current I2C bus clock.
+       Parameters: N/A
+       Returns: Unsigned long representing the clock frequency in Hz.
+  */
+
+  return clockSpeed;
+}
+
+unsigned long busFaults() {
+  /* busFaults - Function which gets the total number of failed I2C
+       transmissions observed since start up.
+       Parameters: N/A
+       Returns: Unsigned long representing the number of failures.
+  */
+
+  return faults;
+}
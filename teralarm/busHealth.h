@@ -0,0 +1,32 @@
+/* TERALARM (FIRMWARE 3) - The effective alarm clock
+
+   busHealth.h - The header file containing functions which run the I2C bus
+     shared by the LCD and RTC in fast mode (400kHz) when both devices
+     support it, and monitor it for failed transmissions so that it can drop
+     back to standard mode (100kHz) automatically. Fast mode is opt in (set
+     fastMode in busHealth.cpp).
+     External Variables / Constants:
+       lcd - Hardware object representing LCD.
+     Third Party Includes:
+       Arduino.h - The main Arduino library containing all platform specific
+         functions and constants.
+       Wire.h - Arduino library used to set the bus clock and probe devices.
+     Local Includes:
+       busHealth.h - Own header file.
+
+   (C) RW128k 2024
+*/
+
+#ifndef BUSHEALTH_H
+#define BUSHEALTH_H
+
+#include "BufferedLCD.h"
+
+extern BufferedLCD lcd;
+
+void beginBus();
+void checkBus();
+unsigned long busClock();
+unsigned long busFaults();
+
+#endif
@@ -31,6 +31,10 @@
        backgroundTasks.h - Handles brightness related requirements and reads
          user input from buttons in a non-blocking way.
        clockAlarmInterface.h - Own header file.
+       customGlyphs.h - Glyph IDs of the large clockface digit segments.
+       screenLayout.h - Positions of the clockface and snooze elements.
+       screenWidgets.h - Draws the snooze countdown as retained widgets.
+       timeKeeping.h - Keeps the shared time object current.
 
    (C) RW128k 2022
 */
@@ -39,6 +43,10 @@
 
 #include "backgroundTasks.h"
 #include "clockAlarmInterface.h"
+#include "customGlyphs.h"
+#include "screenLayout.h"
+#include "screenWidgets.h"
+#include "timeKeeping.h"
 
 #define button1 2
 #define button2 3
@@ -50,92 +58,214 @@
 #define blueLED 12
 #define ldr A0
 
+// length of the buffers each line of the date is composed in (the longest
+// weekday, day and month with separators)
+#define dateLength 24
+
+// set to 1 to draw the time in large digits over the lower 3 lines instead of
+// the regular time and date
+#define largeClockface 0
+
+// segment glyphs of each large digit, in order top left, top right, middle
+// left, middle right, bottom left, bottom right
+static const char bigDigits[10][6] PROGMEM = {
+  {bigDigitTopLeft, bigDigitTopRight, bigDigitLeft, bigDigitRight, bigDigitBottomLeft, bigDigitBottomRight},
+  {' ', bigDigitRight, ' ', bigDigitRight, ' ', bigDigitRight},
+  {bigDigitTop, bigDigitTopRight, bigDigitTopLeft, bigDigitTop, bigDigitBottomLeft, bigDigitBottom},
+  {bigDigitTop, bigDigitTopRight, bigDigitTop, bigDigitTopRight, bigDigitBottom, bigDigitBottomRight},
+  {bigDigitLeft, bigDigitRight, bigDigitTop, bigDigitTopRight, ' ', bigDigitRight},
+  {bigDigitTopLeft, bigDigitTop, bigDigitTop, bigDigitTopRight, bigDigitBottom, bigDigitBottomRight},
+  {bigDigitTopLeft, bigDigitTop, bigDigitTopLeft, bigDigitTopRight, bigDigitBottomLeft, bigDigitBottomRight},
+  {bigDigitTop, bigDigitTopRight, ' ', bigDigitRight, ' ', bigDigitRight},
+  {bigDigitTopLeft, bigDigitTopRight, bigDigitTopLeft, bigDigitTopRight, bigDigitBottomLeft, bigDigitBottomRight},
+  {bigDigitTopLeft, bigDigitTopRight, bigDigitTop, bigDigitTopRight, bigDigitBottom, bigDigitBottomRight}
+};
+
+// snooze countdown screen: title, remaining minutes and seconds (values 0 and
+// 1) and progress bar (value 2) between its bounds
+static const char snoozeTitle[] PROGMEM = "SNOOZING";
+static const char snoozeColon[] PROGMEM = ":";
+static const char snoozeBoundL[] PROGMEM = "\2";
+static const char snoozeBoundR[] PROGMEM = "\4";
+static const Widget snoozeWidgets[] PROGMEM = {
+  {widgetLabel, snoozeTitleX, 0, 8, 0, snoozeTitle},
+  {widgetNumber, snoozeTimeX, snoozeTimeY, 2, 0, NULL},
+  {widgetLabel, snoozeTimeX + 2, snoozeTimeY, 1, 0, snoozeColon},
+  {widgetNumber, snoozeTimeX + 3, snoozeTimeY, 2, 1, NULL},
+  {widgetLabel, 0, snoozeBarY, 1, 0, snoozeBoundL},
+  {widgetBar, 1, snoozeBarY, snoozeBarWidth, 2, NULL},
+  {widgetLabel, snoozeBarWidth + 1, snoozeBarY, 1, 0, snoozeBoundR}
+};
+
+static void printDateLine(const char *line, byte y) {
+  /* printDateLine - Function which prints a line of the date centred on a
+       line of the LCD, or as a marquee scrolled by the seconds of the time if
+       it is wider than the LCD.
+       Parameters:
+         line - The line of the date.
+         y - The line of the LCD to print on.
+       Returns: N/A
+  */
+
+  lcd.setCursor(0, y);
+  if (strlen(line) > layoutCols) {
+    lcd.printScrolling(line, layoutCols, timeObj.sec);
+  } else {
+    lcd.printCentered(line, layoutCols);
+  }
+}
+
+static void printBigDigit(byte x, byte digit) {
+  /* printBigDigit - Function which draws a single large digit to the LCD, 2
+       characters wide and occupying the lower 3 lines. The segments are only
+       written to the LCD buffer, so a digit which is unchanged since the last
+       flush costs no I2C traffic.
+       Parameters:
+         x - The column of the left half of the digit.
+         digit - The value of the digit (0 -> 9).
+       Returns: N/A
+  */
+
+  // print each row of the digit as a pair of segment glyphs
+  for (byte row = 0; row < 3; row++) {
+    lcd.setCursor(x, row + 1);
+    lcd.print(char(pgm_read_byte(&bigDigits[digit][row * 2])));
+    lcd.print(char(pgm_read_byte(&bigDigits[digit][row * 2 + 1])));
+  }
+}
+
+static void printBigTime() {
+  /* printBigTime - Function which draws the RTC time as large digits over the
+       lower 3 lines of the LCD, in the form HH:MM:SS centred on the screen.
+       Parameters: N/A
+       Returns: N/A
+  */
+
+  // column of the left half of each digit, leaving a space between digits of
+  // the same field and a colon between fields
+  static const byte columns[6] = {bigTimeX, bigTimeX + 3, bigTimeX + 6, bigTimeX + 9, bigTimeX + 12, bigTimeX + 15};
+  const byte values[6] = {
+    byte(timeObj.hour / 10), byte(timeObj.hour % 10),
+    byte(timeObj.min / 10), byte(timeObj.min % 10),
+    byte(timeObj.sec / 10), byte(timeObj.sec % 10)
+  };
+
+  // print each digit followed by the gap separating it from the next
+  for (byte i = 0; i < 6; i++) {
+    printBigDigit(columns[i], values[i]);
+    for (byte row = 1; row < 4; row++) {
+      lcd.setCursor(columns[i] + 2, row);
+      lcd.print(i % 2 == 1 && i < 5 && row == 2 ? ':' : ' ');
+    }
+  }
+
+  // blank the unused columns at either side of the time
+  for (byte row = 1; row < 4; row++) {
+    lcd.setCursor(0, row);
+    lcd.fill(' ', bigTimeX);
+    lcd.padTo(layoutCols);
+  }
+}
+
 void updateTime() {
   /* updateTime - Function which draws the clockface to the LCD. Shows alarm
-       time, temperature, RTC time and full date. Completely clears and redraws
-       the UI which can cause flickering if called frequently. Could be fixed
-       by buffering LCD contents.
+       time, temperature, RTC time and full date, or the RTC time in large
+       digits when largeClockface is set. The clockface is composed as a single
+       LCD frame, so only the characters which have changed since the last call
+       (eg the cells of the seconds digit) are sent to the hardware. The frame
+       is sent in the background by getPressed, so a full repaint (eg after
+       leaving a menu) does not delay reading the buttons.
        Parameters: N/A
        Returns: N/A
    */
 
-  // buffer for entire line on clockface
-  char lineBuff[21];
+  // compose the entire clockface before sending changes to the LCD
+  lcd.beginFrame();
   
   // print ALARM TIME at top left or 'OFF' if alarm disabled
-  char alarmStr[6];
+  lcd.setCursor(0, 0);
   if (alarmState) {
-    sprintf(alarmStr, "%02d:%02d", alarmHrs, alarmMins);
+    lcd.printUInt(alarmHrs, 2, true);
+    lcd.print(':');
+    lcd.printUInt(alarmMins, 2, true);
   } else {
-    strcpy_P(alarmStr, reinterpret_cast<const char *>(F("OFF")));
+    lcd.printPadded(F("OFF"), 5);
   }
-  lcd.setCursor(0, 0);
-  lcd.print(alarmStr);
   
-  // print TEMPERATURE at top right
-  char tempStr[6];
-  int tempLength = sprintf(tempStr, "%d%cC", int(rtc.getTemp()), 223); // 233 is character code for degree symbol
-  memset(lineBuff, ' ', 15 - tempLength);
-  memcpy(lineBuff + 15 - tempLength, tempStr, tempLength + 1);
-  lcd.setCursor(5, 0);
-  lcd.print(lineBuff);
+  // print TEMPERATURE (from the last RTC snapshot) at top right, padding from
+  // the alarm time. length is sign, digits, degree symbol and unit
+  int temp = rtcTemp();
+  byte tempLength = (temp < 0 ? 1 : 0) + (abs(temp) < 10 ? 1 : 2) + 2;
+  lcd.padTo(layoutCols - tempLength);
+  if (temp < 0) {lcd.print('-');}
+  lcd.printUInt(abs(temp));
+  lcd.print(char(223)); // 223 is character code for degree symbol
+  lcd.print('C');
+
+  // print RTC TIME in large digits in place of the time and date if enabled
+  if (largeClockface && bigTime) {
+    printBigTime();
+    lcd.flushLater();
+    return;
+  }
   
   // print RTC TIME at upper centre
-  char timeStr[9];
-  sprintf(timeStr, "%02d:%02d:%02d", timeObj.hour, timeObj.min, timeObj.sec);
-  lcd.setCursor(6, 1);
-  lcd.print(timeStr);
+  lcd.setCursor(clockTimeX, clockTimeY);
+  lcd.printUInt(timeObj.hour, 2, true);
+  lcd.print(':');
+  lcd.printUInt(timeObj.min, 2, true);
+  lcd.print(':');
+  lcd.printUInt(timeObj.sec, 2, true);
+
+  // LCDs too short for the date end the clockface after the time
+  if (!clockDate) {
+    lcd.flushLater();
+    return;
+  }
   
-  // print DATE spread out over lower centre and bottom by loading the entire
-  // date string into buffer and storing pointer to begining of second line
-  char dateUpperStr[28];
-  int dateUpperLength = sprintf(dateUpperStr, "%s %d ", dows[timeObj.dow - 1], timeObj.date);
-  int dateLowerLength = sprintf(dateUpperStr + dateUpperLength, "%s %d", months[timeObj.mon - 1], timeObj.year);
-  // set the pointer to the start of the second line to the year if the month
-  // can fit on first line or the month if it can't
-  char *dateLowerStr = dateUpperLength + dateLowerLength > 25 ? dateUpperStr + dateUpperLength : dateUpperStr + dateUpperLength + dateLowerLength - 4;
-
-  // (re)calculate upper / lower date lengths and positions
-  dateLowerLength = dateUpperStr + dateUpperLength + dateLowerLength - dateLowerStr;
-  dateUpperLength = dateLowerStr - dateUpperStr - 1;
-  int dateLowerPos = (20 - dateLowerLength) / 2;
-  int dateUpperPos = (20 - dateUpperLength) / 2;
-
-  // place null terminator at end of first line (before start second line)
-  dateUpperStr[dateUpperLength] = 0;
-
-  // print UPPER DATE line centrally, padding remaining characters in line
-  memset(lineBuff, ' ', dateUpperPos);
-  memset(lineBuff + dateUpperPos + dateUpperLength, ' ', 20 - (dateUpperPos + dateUpperLength));
-  memcpy(lineBuff + dateUpperPos, dateUpperStr, dateUpperLength);
-  lineBuff[20] = 0;
-  lcd.setCursor(0, 2);
-  lcd.print(lineBuff);
-
-  // print LOWER DATE line centrally, padding remaining characters in line
-  memset(lineBuff, ' ', dateLowerPos);
-  memset(lineBuff + dateLowerPos + dateLowerLength, ' ', 20 - (dateLowerPos + dateLowerLength));
-  memcpy(lineBuff + dateLowerPos, dateLowerStr, dateLowerLength);
-  lineBuff[20] = 0;
-  lcd.setCursor(0, 3);
-  lcd.print(lineBuff);
+  // compose DATE spread out over lower centre and bottom. the month is
+  // placed on the first line with the weekday and day if that fits the LCD,
+  // otherwise it is placed on the second line with the year
+  const char *month = months[timeObj.mon - 1];
+  char upper[dateLength];
+  char lower[dateLength];
+  strcpy(upper, dows[timeObj.dow - 1]);
+  strcat(upper, " ");
+  ultoa(timeObj.date, upper + strlen(upper), 10);
+  lower[0] = '\0';
+  if (strlen(upper) + 1 + strlen(month) <= layoutCols) {
+    strcat(upper, " ");
+    strcat(upper, month);
+  } else {
+    strcpy(lower, month);
+    strcat(lower, " ");
+  }
+  ultoa(timeObj.year, lower + strlen(lower), 10);
+
+  // print UPPER and LOWER DATE lines centrally, scrolling a line along once
+  // a second if it is still wider than the LCD
+  printDateLine(upper, 2);
+  printDateLine(lower, 3);
+
+  // leave the changed runs of the clockface to be sent in the background
+  lcd.flushLater();
 }
 
 void soundAlarm() {
   /* soundAlarm - Function called to trigger the alarm and to draw the UI which
        provides a means to disarm. Instructs user to push a sequence of buttons
        of length provided by the global alarmChallenge variable. Displays the
-       time and instruction on the LCD while sounding the buzzer and flashing
-       the LEDs. Handles button presses as answer to instruction and adds/ 
-       subtracts points given correct/incorrect answers until the challenge
-       number is reached and the system is disarmed.
+       time (if the LCD has room) and instruction on the LCD while sounding
+       the buzzer and flashing the LEDs. Handles button presses as answer to
+       instruction and adds/subtracts points given correct/incorrect answers
+       until the challenge number is reached and the system is disarmed.
        Parameters: N/A
        Returns: N/A
   */
 
   // initialise variable for storing number of correct answers
   byte points = 0;
-  randomSeed(rtc.getUnixTime(rtc.getTime()));
+  randomSeed(rtc.getUnixTime(timeObj));
   // set brightness to maximum while alarm is sounding
   analogWrite(lcdLED, 255);
   // halt automatic brightness if enabled, reverts when alarm disabled
@@ -159,37 +289,45 @@ void soundAlarm() {
     while (true) {
       // every 1 second redraw UI and toggle alarm text visibility
       if (millis() - prev1 > 1000) {
-        timeObj = rtc.getTime();
+        tickTime();
 
         // print ALARM TEXT at top left depending on flag and then update flag
         lcd.setCursor(0, 0);
         lcd.print(blinkText ? "ALARM!" : "      ");
         blinkText = !blinkText;
 
-        // print RTC TIME at upper centre
-        char timeStr[9];
-        sprintf(timeStr, "%02d:%02d:%02d", timeObj.hour, timeObj.min, timeObj.sec);
-        lcd.setCursor(6, 1);
-        lcd.print(timeStr);
+        // print RTC TIME at upper centre if the LCD has room below the title
+        if (alarmTime) {
+          lcd.setCursor(layoutCentre(8), alarmTimeY);
+          lcd.printUInt(timeObj.hour, 2, true);
+          lcd.print(':');
+          lcd.printUInt(timeObj.min, 2, true);
+          lcd.print(':');
+          lcd.printUInt(timeObj.sec, 2, true);
+        }
 
         // show question and progress if challenge is not 0
         if (alarmChallenge > 0) {
           // print QUESTION at bottom
-          char instructionStr[9];
-          sprintf(instructionStr, "ENTER: %d", num);
-          lcd.setCursor(6, 3);
-          lcd.print(instructionStr);
-
-          // print PROGRESS (number of points) at top right
-          char pointsStr[6];
-          sprintf(pointsStr, "%d/%d", points + 1, alarmChallenge); // +1 as internally 0 indexed
-          lcd.setCursor(20 - strlen(pointsStr), 0);
-          lcd.print(pointsStr);
+          lcd.setCursor(layoutCentre(8), alarmChallengeY);
+          lcd.print(F("ENTER: "));
+          lcd.printUInt(num);
+
+          // print PROGRESS (number of points) at top right, +1 as internally
+          // 0 indexed
+          byte pointsLength = (points + 1 < 10 ? 1 : 2) + 1 + (alarmChallenge < 10 ? 1 : 2);
+          lcd.setCursor(layoutCols - pointsLength, 0);
+          lcd.printUInt(points + 1);
+          lcd.print('/');
+          lcd.printUInt(alarmChallenge);
         } else {
           // print NO CHALLENGE INSTRUCTION at bottom
-          lcd.setCursor(2, 3);
+          lcd.setCursor(layoutCentre(16), alarmChallengeY);
           lcd.print(F("PRESS ANY BUTTON"));
         }
+
+        // send the redrawn UI to the LCD
+        lcd.flush();
         
         prev1 = millis();
       }
@@ -233,11 +371,12 @@ void soundAlarm() {
         points++;
         // show feedback: blue LED flash, buzzer tone and LCD message
         lcd.clear();
-        lcd.setCursor(6, 1);
+        lcd.setCursor(layoutCentre(8), messageY);
         digitalWrite(buzzer, HIGH);
         digitalWrite(redLED, LOW);
         digitalWrite(blueLED, HIGH);
         lcd.print(F("CORRECT!"));
+        lcd.flush();
         tone(buzzer, 2000);
         delay(500);
         tone(buzzer, 1000);
@@ -257,11 +396,12 @@ void soundAlarm() {
         }
         // show feedback: red LED flash, buzzer tone and LCD message
         lcd.clear();
-        lcd.setCursor(5, 1);
+        lcd.setCursor(layoutCentre(10), messageY);
         digitalWrite(buzzer, HIGH);
         digitalWrite(redLED, HIGH);
         digitalWrite(blueLED, LOW);
         lcd.print(F("INCORRECT!"));
+        lcd.flush();
         tone(buzzer, 1000);
         delay(500);
         tone(buzzer, 2000);
@@ -277,8 +417,9 @@ void soundAlarm() {
   } while (points < alarmChallenge);
 
   // outer loop ended so alarm disabled. print DISABLED MESSAGE at upper centre
-  lcd.setCursor(3, 1);
+  lcd.setCursor(layoutCentre(15), messageY);
   lcd.print(F("ALARM DISABLED!"));
+  lcd.flush();
 
   // turn off both LEDs
   digitalWrite(redLED, LOW);
@@ -303,14 +444,14 @@ void soundAlarm() {
   // return and do not snooze if snooze is set to NONE (00:00)
   if (alarmSnoozeMins == 0 && alarmSnoozeSecs == 0) {return;}
 
-  // draw static parts of snooze countdown UI (title and progres bar bounds)
+  // clear the LCD for the snooze countdown UI, which is drawn in full on the
+  // first pass
   lcd.clear();
-  lcd.setCursor(6, 0);
-  lcd.print(F("SNOOZING"));
-  lcd.setCursor(0, 3);
-  lcd.print(F("\2"));
-  lcd.setCursor(19, 3);
-  lcd.print(F("\4"));
+  bool redraw = true;
+
+  // current and last drawn values of the countdown widgets
+  byte values[3];
+  byte drawn[3];
 
   // initialise timing variables for snooze and flags for flashing the LED
   unsigned long snoozeTimer = millis();
@@ -320,39 +461,28 @@ void soundAlarm() {
   // loop until snooze period has elapsed, tracking elapsed time each iteration
   for (unsigned long elapsed; (elapsed = millis() - snoozeTimer) < snoozeMillis;) {
     // calculate remaining snooze time in minutes and seconds and progress
-    // scaled to 0 -> 18 (number of units on progress bar)
+    // scaled to the number of units on the progress bar
     byte remainingMins = (snoozeMillis - elapsed) / 60000;
     byte remainingSecs = ((snoozeMillis - elapsed) % 60000) / 1000;
-    byte progress = ((float) elapsed / snoozeMillis) * 18;
+    byte progress = ((float) elapsed / snoozeMillis) * snoozeBarWidth;
 
     // run background tasks
     getPressed();
 
-    // print REMAINING TIME at lower center
-    char remainingStr[6];
-    sprintf(remainingStr, "%02d:%02d", remainingMins, remainingSecs);
-    lcd.setCursor(7, 2);
-    lcd.print(remainingStr);
-
-    // character string for progrss bar
-    char bar[19];
-    bar[18] = 0;
-
-    // populate the progress bar with calculated number of block characters and
-    // remaining whitespace
-    if ((elapsed - ((progress * snoozeMillis) / 18)) % 1000 >= 500) {
-      // show additional block for 500ms every 1000ms after last block added
-      memset(bar, 3, progress + 1);
-      memset(bar + progress + 1, ' ', 17 - progress);
-    } else {
-      // otherwise show only correct number of blocks in progress bar
-      memset(bar, 3, progress);
-      memset(bar + progress, ' ', 18 - progress);
-    }
+    // update REMAINING TIME and PROGRESS BAR values, showing an additional
+    // block for 500ms every 1000ms after last block added
+    values[0] = remainingMins;
+    values[1] = remainingSecs;
+    values[2] = progress;
+    if ((elapsed - ((progress * snoozeMillis) / snoozeBarWidth)) % 1000 >= 500) {values[2]++;}
+
+    // draw only the widgets whose values have changed as a single LCD frame
+    lcd.beginFrame();
+    drawWidgets(snoozeWidgets, sizeof(snoozeWidgets) / sizeof(Widget), values, drawn, redraw);
+    redraw = false;
 
-    // print PROGRESS BAR at bottom
-    lcd.setCursor(1, 3);
-    lcd.print(bar);
+    // leave changes to be sent in the background by getPressed
+    lcd.flushLater();
 
     // flash the blue LED for 200ms every 5000ms, tracking state with flag
     if (elapsed % 5000 >= 4800 && flash) {
@@ -370,8 +500,9 @@ void soundAlarm() {
       lcd.clear();
 
       // print SKIPPED MESSAGE at upper centre
-      lcd.setCursor(2, 1);
+      lcd.setCursor(layoutCentre(15), messageY);
       lcd.print(F("SNOOZE SKIPPED!"));
+      lcd.flush();
 
       // sound buzzer 3 times (200ms off, 200ms on) to signify snooze skipped
       for (byte i = 0; i < 6; i++) {
@@ -398,7 +529,7 @@ void soundAlarm() {
   lcd.clear();
 
   // print SNOOZE ALERT TITLE at top
-  lcd.setCursor(3, 0);
+  lcd.setCursor(layoutCentre(14), 0);
   lcd.print(F("SNOOZE ELAPSED"));
 
   // reset timing variable and LED flash flag for use in alert loop
@@ -410,16 +541,21 @@ void soundAlarm() {
   for (unsigned long elapsed = millis(); getPressed() == 0; elapsed = millis() - snoozeTimer) {
     // blink DISMISS INSTRUCTION on / off at lower center / bottom every 750ms
     if (elapsed % 1500 >= 750) {
-      lcd.setCursor(2, 2);
+      lcd.setCursor(layoutCentre(16), promptY);
       lcd.print(F("                "));
-      lcd.setCursor(5, 3);
-      lcd.print(F("          "));
+      if (promptAction) {
+        lcd.setCursor(layoutCentre(10), promptY + 1);
+        lcd.print(F("          "));
+      }
     } else {
-      lcd.setCursor(2, 2);
+      lcd.setCursor(layoutCentre(16), promptY);
       lcd.print(F("PRESS ANY BUTTON"));
-      lcd.setCursor(5, 3);
-      lcd.print(F("TO DISMISS"));
+      if (promptAction) {
+        lcd.setCursor(layoutCentre(10), promptY + 1);
+        lcd.print(F("TO DISMISS"));
+      }
     }
+    lcd.flush();
 
     // flash the red LED and sound buzzer for 200ms every 5000ms, tracking
     // state with flag
@@ -440,8 +576,9 @@ void soundAlarm() {
   lcd.clear();
 
   // print ALERT DISMISSED MESSAGE at upper centre
-  lcd.setCursor(5, 1);
+  lcd.setCursor(layoutCentre(10), messageY);
   lcd.print(F("DISMISSED!"));
+  lcd.flush();
 
   // sound buzzer 3 times (400ms off, 400ms on) to signify alert dismissed
   for (byte i = 0; i < 6; i++) {
@@ -0,0 +1,42 @@
+/* TERALARM (FIRMWARE 3) - The effective alarm clock
+
+   customGlyphs.cpp - The source file containing the bitmaps of the custom LCD
+     characters (glyphs) and the table which maps glyph IDs to them. Glyph IDs
+     are control characters which can be placed in printed strings and are
+     translated to custom character slots by the LCD as they are flushed.
+     External Variables / Constants: N/A
+     Third Party Includes:
+       Arduino.h - The main Arduino library containing all platform specific
+         functions and constants.
+     Local Includes:
+       customGlyphs.h - Own header file.
+
+   (C) RW128k 2024
+*/
+
+#include <Arduino.h>
+
+#include "customGlyphs.h"
+
+// bitmaps for blinking cursor and brightness / progress bar
+static const uint8_t blinkChar[8] PROGMEM = {0b11111, 0b11111, 0b11111, 0b11111, 0b11111, 0b11111, 0b11111, 0b11111};
+static const uint8_t brightBoundL[8] PROGMEM = {0b00011, 0b00011, 0b00011, 0b00011, 0b00011, 0b00011, 0b00011, 0b00011};
+static const uint8_t brightFill[8] PROGMEM = {0b00000, 0b11111, 0b11111, 0b11111, 0b11111, 0b11111, 0b11111, 0b00000};
+static const uint8_t brightBoundR[8] PROGMEM = {0b11000, 0b11000, 0b11000, 0b11000, 0b11000, 0b11000, 0b11000, 0b11000};
+
+// bitmaps for large clockface digit segments
+static const uint8_t segTop[8] PROGMEM = {0b11111, 0b11111, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000};
+static const uint8_t segBottom[8] PROGMEM = {0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b11111, 0b11111};
+static const uint8_t segLeft[8] PROGMEM = {0b11000, 0b11000, 0b11000, 0b11000, 0b11000, 0b11000, 0b11000, 0b11000};
+static const uint8_t segRight[8] PROGMEM = {0b00011, 0b00011, 0b00011, 0b00011, 0b00011, 0b00011, 0b00011, 0b00011};
+static const uint8_t segTopLeft[8] PROGMEM = {0b11111, 0b11111, 0b11000, 0b11000, 0b11000, 0b11000, 0b11000, 0b11000};
+static const uint8_t segTopRight[8] PROGMEM = {0b11111, 0b11111, 0b00011, 0b00011, 0b00011, 0b00011, 0b00011, 0b00011};
+static const uint8_t segBottomLeft[8] PROGMEM = {0b11000, 0b11000, 0b11000, 0b11000, 0b11000, 0b11000, 0b11111, 0b11111};
+static const uint8_t segBottomRight[8] PROGMEM = {0b00011, 0b00011, 0b00011, 0b00011, 0b00011, 0b00011, 0b11111, 0b11111};
+
+// table of bitmaps indexed by glyph ID (0x08 -> 0x0F reserved for slots)
+const uint8_t *const glyphTable[32] PROGMEM = {
+  NULL, blinkChar, brightBoundL, brightFill, brightBoundR, NULL, NULL, NULL,
+  NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+  segTop, segBottom, segLeft, segRight, segTopLeft, segTopRight, segBottomLeft, segBottomRight
+};
@@ -0,0 +1,41 @@
+/* TERALARM (FIRMWARE 3) - The effective alarm clock
+
+   customGlyphs.h - The header file containing the bitmaps of the custom LCD
+     characters (glyphs) and the table which maps glyph IDs to them. Glyph IDs
+     are control characters which can be placed in printed strings and are
+     translated to custom character slots by the LCD as they are flushed.
+       \1 - Block used for the blinking cursor and boot animation.
+       \2 - Left bound of brightness and snooze progress bars.
+       \3 - Fill of brightness and snooze progress bars.
+       \4 - Right bound of brightness and snooze progress bars.
+       \20 -> \27 - Segments of large clockface digits (see bigDigitTop etc).
+     External Variables / Constants: N/A
+     Third Party Includes:
+       Arduino.h - The main Arduino library containing all platform specific
+         functions and constants.
+     Local Includes:
+       customGlyphs.h - Own header file.
+
+   (C) RW128k 2024
+*/
+
+#ifndef CUSTOMGLYPHS_H
+#define CUSTOMGLYPHS_H
+
+#include <Arduino.h>
+
+// glyph IDs of large clockface digit segments. each digit is 2 characters
+// wide and 3 high, built from bars along the top (top and middle rows) or
+// bottom (bottom row) of a character and strokes down its left or right side
+#define bigDigitTop 0x10
+#define bigDigitBottom 0x11
+#define bigDigitLeft 0x12
+#define bigDigitRight 0x13
+#define bigDigitTopLeft 0x14
+#define bigDigitTopRight 0x15
+#define bigDigitBottomLeft 0x16
+#define bigDigitBottomRight 0x17
+
+extern const uint8_t *const glyphTable[32];
+
+#endif
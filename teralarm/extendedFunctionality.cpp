@@ -20,6 +20,7 @@
          enabled or disabled (synchronised with EEPROM).
        brightness - Brightness setting value (synchronised with EEPROM).
        dows - Constant array of strings holding the days of the week.
+       timeObj - Shared current Date / Time object across sources.
      Third Party Includes:
        Arduino.h - The main Arduino library containing all platform specific
          functions and constants.
@@ -29,6 +30,9 @@
      Local Includes:
        backgroundTasks.h - Handles brightness related requirements and reads
          user input from buttons in a non-blocking way.
+       busHealth.h - Provides the I2C bus clock and failure count.
+       screenLayout.h - Positions of the timer and debug screen elements.
+       timeKeeping.h - Keeps the shared time object current.
        extendedFunctionality.h - Own header file.
 
    (C) RW128k 2022
@@ -37,6 +41,9 @@
 #include <Arduino.h>
 
 #include "backgroundTasks.h"
+#include "busHealth.h"
+#include "screenLayout.h"
+#include "timeKeeping.h"
 #include "extendedFunctionality.h"
 
 #define buzzer 8
@@ -44,6 +51,29 @@
 #define blueLED 12
 #define ldr A0
 
+// length of the buffer each carousel line is composed in before printing,
+// and the number of carousel items (the last two, LCD I2C traffic, only on
+// the I2C backpack)
+#define carouselLength 32
+#define carouselItems (lcdParallel ? 10 : 12)
+
+static void appendUInt(char *line, unsigned long value, byte width) {
+  /* appendUInt - Function which appends a number to the end of a line being
+       composed, zero padded to a minimum number of digits.
+       Parameters:
+         line - The line to append to, which must have room for the digits.
+         value - The number to append.
+         width - The minimum number of digits, 0 for no padding.
+       Returns: N/A
+  */
+
+  char digits[11];
+  ultoa(value, digits, 10);
+  line += strlen(line);
+  for (byte i = strlen(digits); i < width; i++) {*line++ = '0';}
+  strcpy(line, digits);
+}
+
 void secretTimer() {
   /* secretTimer - Function that provides a UI to start and monitor a 100 
        second countdown timer. A blinking instruction is shown on the LCD until
@@ -60,20 +90,24 @@ void secretTimer() {
   unsigned long prev = 0;
   bool blinkText = false;
 
-  // set up LCD with initial UI title
-  lcd.setCursor(0, 0);
-  lcd.print(F("100 SECOND COUNTDOWN"));
-
   // loop (wait and blink text) until a button is pressed
-  while(getPressed() == 0) {
+  for (byte step = 0; getPressed() == 0;) {
     // only execute loop body every 0.75 seconds
     if (millis() - prev < 750) {continue;}
 
+    // print UI title, scrolling along a character each time if it is wider
+    // than the LCD
+    lcd.setCursor(0, 0);
+    lcd.printScrolling(F("100 SECOND COUNTDOWN"), layoutCols, step++);
+
     // toggle printing instruction to screen based on flag
-    lcd.setCursor(2, 2);
+    lcd.setCursor(layoutCentre(16), promptY);
     lcd.print(blinkText ? F("                ") : F("PRESS ANY BUTTON"));
-    lcd.setCursor(6, 3);
-    lcd.print(blinkText ? F("        ") : F("TO START"));
+    if (promptAction) {
+      lcd.setCursor(layoutCentre(8), promptY + 1);
+      lcd.print(blinkText ? F("        ") : F("TO START"));
+    }
+    lcd.flush();
     
     // update flag and set last blinked time to now (to wait 0.75 seconds)
     blinkText = !blinkText;
@@ -136,8 +170,9 @@ void secretTimer() {
     }
 
     // print REMAINING TIME in seconds to the upper centre of the LCD
-    lcd.setCursor(8, 1);
+    lcd.setCursor(layoutCentre(4), messageY);
     lcd.print(timerStr);
+    lcd.flush();
   }
 
   // silence buzzer and turn of red LED when timer has ended
@@ -151,7 +186,7 @@ void secretTimer() {
     if (millis() - prev < 750) {continue;}
     
     // toggle printing remaining time (0s) to screen and blue LED based on flag
-    lcd.setCursor(8, 1);
+    lcd.setCursor(layoutCentre(4), messageY);
     lcd.print(blinkText ? F("    ") : F("00.0"));
     digitalWrite(blueLED, blinkText ? LOW : HIGH);
 
@@ -166,7 +201,12 @@ void debug() {
        internal/raw form. The top line of the LCD displays a carousel of
        settings stored in EEPROM and data held in the RTC registers while the
        remaining 3 lines show dynamic measurements (light intensity,
-       temperature and uptime). Each item in the carousel is shown for 2
+       temperature and uptime), which take turns on the second line of LCDs
+       with fewer than 4 rows. The carousel ends with the I2C bus clock and
+       failure count, the rate of RTC time reads with the measured clock
+       drift and the average LCD I2C traffic per second of uptime (only on
+       the I2C backpack). Items wider than the LCD scroll along by one
+       character each redraw. Each item in the carousel is shown for 2
        seconds. Raw light intensity measurements are printed over serial on
        every loop. Debug mode can be exited by pressing any button.
        Parameters: N/A
@@ -181,135 +221,172 @@ void debug() {
   consumePress();
   lcd.clear();
 
-  // print constant values to LCD
-  lcd.setCursor(0, 1);
-  lcd.print(F("TEMPERATURE: "));
-  lcd.setCursor(0, 2);
-  lcd.print(F("LIGHT: "));
-  lcd.setCursor(0, 3);
-  lcd.print(F("UPTIME:   d  h  m  s"));
-
   // loop (drawing debug UI) until a button is pressed
   while(getPressed() == 0) {
-    // buffer for holding the string of the currently processing line
-    char lineBuff[21];
-    int length;
-
     // print raw light intensity value followed by newline over serial
-    sprintf(lineBuff, "%d", analogRead(ldr));
-    Serial.println(lineBuff);
+    Serial.println(analogRead(ldr));
 
     // redraw only every 0.2 seconds
     if (millis() - prev < 200) {
       continue;
     }
 
-    // fill buffer for TOP LINE based on carousel position
+    // bring the shared time up to date for the RTC items (also reading the
+    // result of the temperature conversion) and request a fresh temperature
+    // conversion every second for the 0.1 degree display
+    tickTime();
+    if (carousel % 5 == 0) {convertTemp();}
+
+    // compose all lines as a single LCD frame
+    lcd.beginFrame();
+
+    // compose TOP LINE based on carousel position, then print it scrolling
+    // by one character per redraw if it is wider than the LCD
+    char line[carouselLength] = "";
     switch (carousel / 10) {
       case 0: {
         // static debug mode title
-        strcpy_P(lineBuff, reinterpret_cast<const char *>(F("\1\1\1\1\1DEBUG MODE\1\1\1\1\1")));
-        length = 20;
+        strcpy_P(line, PSTR("\1\1\1\1\1DEBUG MODE\1\1\1\1\1"));
         break;
       } case 1: {
         // unix time from RTC
-        length = sprintf(lineBuff, "UNIX: %ld", rtc.getUnixTime(rtc.getTime()));
+        strcpy_P(line, PSTR("UNIX: "));
+        appendUInt(line, rtc.getUnixTime(timeObj), 0);
         break;
       } case 2: {
         // numerical day of week from RTC and (textual version)
-        byte numDow = rtc.getTime().dow;
-        length = sprintf(lineBuff, "DAY: %d (%s)", numDow, dows[numDow - 1]);
+        byte numDow = timeObj.dow;
+        strcpy_P(line, PSTR("DAY: "));
+        appendUInt(line, numDow, 0);
+        strcat_P(line, PSTR(" ("));
+        strcat(line, dows[numDow - 1]);
+        strcat_P(line, PSTR(")"));
         break;
       } case 3: {
         // alarm time from RAM (synced with EEPROM)
-        length = sprintf(lineBuff, "ALARM TIME: %02d:%02d", alarmHrs, alarmMins);
+        strcpy_P(line, PSTR("ALARM TIME: "));
+        appendUInt(line, alarmHrs, 2);
+        strcat_P(line, PSTR(":"));
+        appendUInt(line, alarmMins, 2);
         break;
       } case 4: {
         // alarm challenge from RAM (synced with EEPROM)
-        length = sprintf(lineBuff, "ALARM CHALLENGE: %d", alarmChallenge);
+        strcpy_P(line, PSTR("ALARM CHALLENGE: "));
+        appendUInt(line, alarmChallenge, 0);
         break;
       } case 5: {
         // alarm snooze from RAM (synced with EEPROM)
-        length = sprintf(lineBuff, "ALARM SNOOZE: %02dm%02ds", alarmSnoozeMins, alarmSnoozeSecs);
+        strcpy_P(line, PSTR("ALARM SNOOZE: "));
+        appendUInt(line, alarmSnoozeMins, 2);
+        strcat_P(line, PSTR("m"));
+        appendUInt(line, alarmSnoozeSecs, 2);
+        strcat_P(line, PSTR("s"));
         break;
       } case 6: {
         // alarm state from RAM (synced with EEPROM) numerical and textual form
-        if (alarmState) {
-          strcpy_P(lineBuff, reinterpret_cast<const char *>(F("ALARM STATE: 1 (ON)")));
-          length = 19;
-        } else {
-          strcpy_P(lineBuff, reinterpret_cast<const char *>(F("ALARM STATE: 0 (OFF)")));
-          length = 20;
-        }
+        strcpy_P(line, alarmState ? PSTR("ALARM STATE: 1 (ON)") : PSTR("ALARM STATE: 0 (OFF)"));
         break;
       } case 7: {
         // internal numerical brightness from RAM (synced with EEPROM)
-        length = sprintf(lineBuff, "BRIGHTNESS: %d", brightness);
+        strcpy_P(line, PSTR("BRIGHTNESS: "));
+        appendUInt(line, brightness, 0);
         if (brightness == 0) {
-          strcat(lineBuff, " (AUTO)");
-          length += 7;
+          strcat_P(line, PSTR(" (AUTO)"));
         } else if (brightness == 1) {
-          strcat(lineBuff, " (OFF)");
-          length += 6;
+          strcat_P(line, PSTR(" (OFF)"));
         } else if (brightness == 17) {
-          strcat(lineBuff, " (MAX)");
-          length += 6;
+          strcat_P(line, PSTR(" (MAX)"));
         }
         break;
+      } case 8: {
+        // I2C bus clock in kHz and failed transmissions since start up
+        strcpy_P(line, PSTR("I2C: "));
+        appendUInt(line, busClock() / 1000, 0);
+        strcat_P(line, PSTR("KHZ ERR: "));
+        appendUInt(line, busFaults(), 0);
+        break;
+      } case 9: {
+        // average RTC time reads per minute of uptime and drift of millis
+        // against the RTC
+        unsigned long uptime = max(millis() / 1000, 1UL);
+        long drift = timeDrift();
+        strcpy_P(line, PSTR("RTC: "));
+        appendUInt(line, timeSyncs() * 60 / uptime, 0);
+        strcat_P(line, drift < 0 ? PSTR("/MIN -") : PSTR("/MIN +"));
+        appendUInt(line, abs(drift), 0);
+        strcat_P(line, PSTR("PPM"));
+        break;
+      #if !lcdParallel
+      } case 10: {
+        // average LCD transactions and bytes sent per second of uptime
+        unsigned long uptime = max(millis() / 1000, 1UL);
+        strcpy_P(line, PSTR("LCD/S: "));
+        appendUInt(line, lcd.i2cTransactions() / uptime, 0);
+        strcat_P(line, PSTR(" TX "));
+        appendUInt(line, lcd.i2cBytes() / uptime, 0);
+        strcat_P(line, PSTR(" B"));
+        break;
+      } case 11: {
+        // average LCD bus occupancy in microseconds per second of uptime
+        unsigned long uptime = max(millis() / 1000, 1UL);
+        strcpy_P(line, PSTR("LCD BUS: "));
+        appendUInt(line, lcd.i2cMicros() / uptime, 0);
+        strcat_P(line, PSTR("US/S"));
+        break;
+      #endif
       }
     }
-
-    // print FIRST LINE from buffer
-    memset(lineBuff + length, ' ', 20 - length); // 20 being the total characters in the line
-    lineBuff[20] = 0;
     lcd.setCursor(0, 0);
-    lcd.print(lineBuff);
-
-    // print TEMPERATURE at second line with 0.1 degree precision
-    char tempStr[6];
-    length = sprintf(lineBuff, "%s%cC", dtostrf(rtc.getTemp(), 0, 1, tempStr), 223); // 233 is character code for degree symbol
-    memset(lineBuff + length, ' ', 7 - length); // 7 being the remaining characters in the line following "TEMPERATURE: " -->
-    lineBuff[7] = 0;
-    lcd.setCursor(13, 1);
-    lcd.print(lineBuff);
-
-    // print LIGHT INTENSITY AND (BRIGHTNESS TO WRITE) at third line
-    short light = analogRead(ldr);
-    length = sprintf(lineBuff, "%d (%d)", light, brightCurve(light));
-    memset(lineBuff + length, ' ', 13 - length); // 13 being the remaining characters in the line following "LIGHT: " -->
-    lineBuff[13] = 0;
-    lcd.setCursor(7, 2);
-    lcd.print(lineBuff);
-    
-    // parse uptime by spliting milliseconds to days, hours, minutes, seconds
-    unsigned long secs = millis() / 1000;
-    byte days = secs / 86400;
-    secs = secs % 86400;
-    byte hours = secs / 3600;
-    secs = secs % 3600;
-    byte mins = secs / 60;
-    secs = secs % 60;
-
-    // print UPTIME in split form at fourth line
-    sprintf(lineBuff, "%02d %02d %02d %02ld", days, hours, mins, secs);
-
-    // insert terminators between values (use single buffer for 4 strings)
-    lineBuff[2] = 0;
-    lineBuff[5] = 0;
-    lineBuff[8] = 0;
-
-    // print the values individually
-    lcd.setCursor(8, 3);
-    lcd.print(lineBuff);
-    lcd.setCursor(11, 3);
-    lcd.print(lineBuff + 3);
-    lcd.setCursor(14, 3);
-    lcd.print(lineBuff + 6);
-    lcd.setCursor(17, 3);
-    lcd.print(lineBuff + 9);
+    lcd.printScrolling(line, layoutCols, carousel % 10);
+
+    // compose each MEASUREMENT line below, each on its own line or, on LCDs
+    // too short for them all, taking turns on the second line with the
+    // carousel, then print it scrolling if it is wider than the LCD
+    for (byte i = 0; i < 3; i++) {
+      if (!layoutTall && i != (carousel / 10) % 3) {continue;}
+      switch (i) {
+        case 0: {
+          // temperature with 0.1 degree precision
+          int tempTenths = round(rtcTemp() * 10);
+          strcpy_P(line, tempTenths < 0 ? PSTR("TEMPERATURE: -") : PSTR("TEMPERATURE: "));
+          appendUInt(line, abs(tempTenths) / 10, 0);
+          strcat_P(line, PSTR("."));
+          appendUInt(line, abs(tempTenths) % 10, 0);
+          strcat_P(line, PSTR("\xDF" "C")); // 0xDF is character code for degree symbol
+          break;
+        } case 1: {
+          // light intensity and (brightness to write)
+          short light = analogRead(ldr);
+          strcpy_P(line, PSTR("LIGHT: "));
+          appendUInt(line, light, 0);
+          strcat_P(line, PSTR(" ("));
+          appendUInt(line, brightCurve(light), 0);
+          strcat_P(line, PSTR(")"));
+          break;
+        } case 2: {
+          // uptime split from milliseconds to days, hours, minutes, seconds
+          unsigned long secs = millis() / 1000;
+          strcpy_P(line, PSTR("UPTIME: "));
+          appendUInt(line, byte(secs / 86400), 2);
+          strcat_P(line, PSTR("d"));
+          appendUInt(line, (secs % 86400) / 3600, 2);
+          strcat_P(line, PSTR("h"));
+          appendUInt(line, (secs % 3600) / 60, 2);
+          strcat_P(line, PSTR("m"));
+          appendUInt(line, secs % 60, 2);
+          strcat_P(line, PSTR("s"));
+          break;
+        }
+      }
+      lcd.setCursor(0, debugMeasurementY(i));
+      lcd.printScrolling(line, layoutCols, carousel % 10);
+    }
+
+    // send the changed runs of all lines to the LCD
+    lcd.flush();
 
     // increment carousel and reset timer
     prev = millis();
-    carousel = (carousel + 1) % 80;
+    carousel = (carousel + 1) % (carouselItems * 10);
   }
 }
@@ -0,0 +1,78 @@
+/* TERALARM (FIRMWARE 3) - The effective alarm clock
+
+   screenLayout.h - The header file containing the positions of the elements
+     of every screen, derived from the dimensions of the BufferedLCD type.
+     The positions are constant expressions, so they are folded into the code
+     and widget tables at compile time, and a build for a different LCD (eg
+     16x2, set by lcdCols and lcdRows in BufferedLCD.h) lays the screens out
+     to fit without changes to the drawing code. LCDs with fewer than 4 rows
+     omit the date from the clockface, the time from the alarm screen and
+     the second line of prompts, move the snooze time onto the title line and
+     show the debug measurements one at a time.
+     External Variables / Constants: N/A
+     Third Party Includes: N/A
+     Local Includes:
+       BufferedLCD.h - Provides the LCD dimensions.
+
+   (C) RW128k 2024
+*/
+
+#ifndef SCREENLAYOUT_H
+#define SCREENLAYOUT_H
+
+#include "BufferedLCD.h"
+
+#define layoutCols BufferedLCD::maxX
+#define layoutRows BufferedLCD::maxY
+#define layoutTall (layoutRows >= 4)
+
+// column of a field of the given length centred on the LCD, one character to
+// the left where it cannot be exactly centred (as printCentered places it)
+#define layoutCentre(length) ((layoutCols - (length)) / 2)
+
+// messages, editors and confirmations: title at the top, or message on the
+// upper centre line, with the value being edited or set below it
+#define messageY (layoutTall ? 1 : 0)
+#define valueY (layoutTall ? 2 : 1)
+
+// prompts: "PRESS ANY BUTTON" on the lower centre line, followed by what it
+// does on the bottom line where there is room
+#define promptY (layoutTall ? 2 : 1)
+#define promptAction layoutTall
+
+// clockface: alarm and temperature on the top line, time (HH:MM:SS) centred
+// on the second and the date split over the last two lines if present
+#define clockTimeX ((layoutCols - 8) / 2)
+#define clockTimeY 1
+#define clockDate layoutTall
+
+// large clockface: 6 digits of 2 characters each separated by a gap over the
+// lower 3 lines, only on LCDs wide and tall enough to fit it
+#define bigTimeX (layoutCols >= 18 ? (layoutCols - 18) / 2 : 0)
+#define bigTime (layoutTall && layoutCols >= 18)
+
+// snooze countdown: title centred at the top, remaining time (MM:SS) centred
+// below (or right aligned on the title line) and progress bar at the bottom
+#define snoozeTitleX (layoutTall ? (layoutCols - 8) / 2 : 0)
+#define snoozeTimeX (layoutTall ? (layoutCols - 5) / 2 : layoutCols - 5)
+#define snoozeTimeY (layoutTall ? 2 : 0)
+#define snoozeBarWidth (layoutCols - 2)
+#define snoozeBarY (layoutRows - 1)
+
+// alarm: flashing title and challenge progress on the top line, time centred
+// below where there is room and the challenge on the bottom line
+#define alarmTime layoutTall
+#define alarmTimeY 1
+#define alarmChallengeY (layoutRows - 1)
+
+// debug: carousel on the top line and the measurements (temperature, light
+// and uptime) on a line each below, or taking turns on the second line
+#define debugMeasurementY(index) (layoutTall ? (index) + 1 : 1)
+
+// brightness: title centred at the top and bar (with its bounds inset by one
+// character) on the third line, or second on shorter LCDs
+#define brightTitleX ((layoutCols - 10) / 2)
+#define brightBarY (layoutTall ? 2 : 1)
+#define brightBarWidth (layoutCols - 4)
+
+#endif
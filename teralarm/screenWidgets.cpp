@@ -0,0 +1,79 @@
+/* TERALARM (FIRMWARE 3) - The effective alarm clock
+
+   screenWidgets.cpp - The source file containing the retained mode widget
+     layer. A screen is declared as a table of widgets in program memory, each
+     with a position, width and the index of the value it displays. The
+     caller updates an array of values on every pass and only the widgets
+     whose value differs from the one last drawn are formatted into the LCD
+     buffer, so static screens cost almost nothing per loop.
+     External Variables / Constants:
+       lcd - Hardware object representing LCD.
+     Third Party Includes:
+       Arduino.h - The main Arduino library containing all platform specific
+         functions and constants.
+     Local Includes:
+       screenWidgets.h - Own header file.
+
+   (C) RW128k 2024
+*/
+
+#include <Arduino.h>
+
+#include "screenWidgets.h"
+
+void drawWidgets(const Widget *widgets, byte count, const byte *values, byte *drawn, bool redraw) {
+  /* drawWidgets - Function which draws the widgets of a screen into the LCD
+       buffer. Each widget is only formatted if its value has changed since it
+       was last drawn, or if the whole screen is being redrawn (eg after the
+       LCD has been cleared). Labels have no value and are only drawn on
+       redraw. Nothing is sent to the LCD, the caller should draw within a
+       frame and flush afterwards. Widgets with the value widgetHidden are
+       skipped, leaving their cells to the widget sharing them.
+       Parameters:
+         widgets - Pointer to the table of widgets in program memory.
+         count - Number of widgets in the table.
+         values - Array of current values, indexed by each widget's value.
+         drawn - Array of the values last drawn, indexed by each widget's
+           value. Updated as widgets are drawn.
+         redraw - Boolean which is true to draw every widget.
+       Returns: N/A
+  */
+
+  for (byte i = 0; i < count; i++) {
+    // copy widget out of program memory
+    Widget widget;
+    memcpy_P(&widget, widgets + i, sizeof(Widget));
+
+    // skip widgets showing the same value as last drawn
+    if (!redraw && (widget.type == widgetLabel || values[widget.value] == drawn[widget.value])) {continue;}
+    if (widget.type != widgetLabel && values[widget.value] == widgetHidden) {continue;}
+
+    lcd.setCursor(widget.x, widget.y);
+    switch (widget.type) {
+      case widgetLabel: {
+        lcd.printPadded(reinterpret_cast<const __FlashStringHelper *>(widget.data), widget.width);
+        break;
+      } case widgetNumber: {
+        lcd.printUInt(values[widget.value], widget.width, true);
+        break;
+      } case widgetText: {
+        // look up the string in the table in program memory
+        const char *const *strings = static_cast<const char *const *>(widget.data);
+        const char *string = reinterpret_cast<const char *>(pgm_read_ptr(strings + values[widget.value]));
+        lcd.printCentered(reinterpret_cast<const __FlashStringHelper *>(string), widget.width);
+        break;
+      } case widgetBar: {
+        lcd.fill(3, values[widget.value]);
+        lcd.fill(' ', widget.width - values[widget.value]);
+        break;
+      }
+    }
+  }
+
+  // record the values drawn once every widget sharing them has been drawn
+  for (byte i = 0; i < count; i++) {
+    if (pgm_read_byte(&widgets[i].type) == widgetLabel) {continue;}
+    byte value = pgm_read_byte(&widgets[i].value);
+    drawn[value] = values[value];
+  }
+}
@@ -0,0 +1,55 @@
+/* TERALARM (FIRMWARE 3) - The effective alarm clock
+
+   screenWidgets.h - The header file containing the retained mode widget
+     layer. A screen is declared as a table of widgets in program memory, each
+     with a position, width and the index of the value it displays. The
+     caller updates an array of values on every pass and only the widgets
+     whose value differs from the one last drawn are formatted into the LCD
+     buffer, so static screens cost almost nothing per loop.
+       widgetLabel - Constant string (in program memory) drawn on redraw only.
+       widgetNumber - Value as a zero padded number filling the width.
+       widgetText - String selected by value from an array of strings,
+         centred within the width. Both the array and the strings are in
+         program memory.
+       widgetBar - Progress bar of value filled blocks within the width.
+     A widget whose value is widgetHidden is not drawn, so widgets can share
+     the same cells (eg a bar replaced by text) with only one shown at once.
+     External Variables / Constants:
+       lcd - Hardware object representing LCD.
+     Third Party Includes:
+       Arduino.h - The main Arduino library containing all platform specific
+         functions and constants.
+     Local Includes:
+       screenWidgets.h - Own header file.
+
+   (C) RW128k 2024
+*/
+
+#ifndef SCREENWIDGETS_H
+#define SCREENWIDGETS_H
+
+#include <Arduino.h>
+
+#include "BufferedLCD.h"
+
+#define widgetLabel 0
+#define widgetNumber 1
+#define widgetText 2
+#define widgetBar 3
+
+#define widgetHidden 0xFF
+
+struct Widget {
+  byte type;
+  byte x;
+  byte y;
+  byte width;
+  byte value;
+  const void *data;
+};
+
+extern BufferedLCD lcd;
+
+void drawWidgets(const Widget *widgets, byte count, const byte *values, byte *drawn, bool redraw);
+
+#endif
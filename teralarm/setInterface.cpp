@@ -14,6 +14,7 @@
      Local Includes:
        backgroundTasks.h - Handles brightness related requirements and reads
          user input from buttons in a non-blocking way.
+       screenLayout.h - Positions of the edited values and messages.
        setInterface.h - Own header file.
 
    (C) RW128k 2022
@@ -22,6 +23,7 @@
 #include <Arduino.h>
 
 #include "backgroundTasks.h"
+#include "screenLayout.h"
 #include "setInterface.h"
 
 #define buzzer 8
@@ -63,16 +65,18 @@ bool chTime(byte &setHrs, byte &setMins) {
       // print flashing cursor if flag is true
       if (blinkText){
         // print cursor at hours or minutes position based on selected value
-        lcd.setCursor(set ? 7 : 10, 2);
+        lcd.setCursor(layoutCentre(5) + (set ? 0 : 3), valueY);
         lcd.print(F("\1\1"));
       // print selected value if flag is false
       } else {
-        // format and repaint entire time string
-        char setStr[6];
-        sprintf(setStr, "%02d:%02d", setHrs, setMins);
-        lcd.setCursor(7, 2);
-        lcd.print(setStr);
+        // repaint entire time string
+        lcd.setCursor(layoutCentre(5), valueY);
+        lcd.printUInt(setHrs, 2, true);
+        lcd.print(':');
+        lcd.printUInt(setMins, 2, true);
       }
+      // send any screen composed by the caller along with the value
+      lcd.flush();
       blinkText = !blinkText;
       prev = millis();
     }
@@ -157,25 +161,28 @@ bool chMinsSecs(byte &setMins, byte &setSecs) {
       // print flashing cursor for NONE if flag is true, seconds is selected,
       // and both minutes and seconds are 0
       if (blinkText && !set && setMins == 0 && setSecs == 0){
-        lcd.setCursor(7, 2);
+        lcd.setCursor(layoutCentre(6), valueY);
         lcd.print(F(" \1\1\1\1 "));
       // print flashing cursor for minutes or seconds if flag is true only
       } else if (blinkText) {
         // print cursor at minutes or seconds position based on selected value
-        lcd.setCursor(set ? 7 : 10, 2);
+        lcd.setCursor(layoutCentre(6) + (set ? 0 : 3), valueY);
         lcd.print(F("\1\1"));
       // print selected value if flag is false
       } else {
-        // format and repaint entire time period string or NONE
-        char setStr[7];
+        // repaint entire time period string or NONE
+        lcd.setCursor(layoutCentre(6), valueY);
         if (!set && setMins == 0 && setSecs == 0) {
-          strcpy_P(setStr, reinterpret_cast<const char *>(F(" NONE ")));
+          lcd.print(F(" NONE "));
         } else {
-          sprintf(setStr, "%02dm%02ds", setMins, setSecs);
+          lcd.printUInt(setMins, 2, true);
+          lcd.print('m');
+          lcd.printUInt(setSecs, 2, true);
+          lcd.print('s');
         }
-        lcd.setCursor(7, 2);
-        lcd.print(setStr);
       }
+      // send any screen composed by the caller along with the value
+      lcd.flush();
       blinkText = !blinkText;
       prev = millis();
     }
@@ -264,23 +271,27 @@ bool chDate(byte &setDay, byte &setMonth, short &setYear) {
       if (blinkText) {
         // print cursor at day, month or year position based on selected value
         if (set == 0) {
-          lcd.setCursor(5, 2);
+          lcd.setCursor(layoutCentre(10), valueY);
           lcd.print(F("\1\1"));
         } else if (set == 1) {
-          lcd.setCursor(8, 2);
+          lcd.setCursor(layoutCentre(10) + 3, valueY);
           lcd.print(F("\1\1"));
         } else if (set == 2) {
-          lcd.setCursor(11, 2);
+          lcd.setCursor(layoutCentre(10) + 6, valueY);
           lcd.print(F("\1\1\1\1")); // appropriate size for year
         }
       // print selected value if flag is false
       } else {
-        // format and repaint entire date string
-        char setStr[11];
-        sprintf(setStr, "%02d/%02d/%d", setDay, setMonth, setYear);
-        lcd.setCursor(5, 2);
-        lcd.print(setStr);
+        // repaint entire date string
+        lcd.setCursor(layoutCentre(10), valueY);
+        lcd.printUInt(setDay, 2, true);
+        lcd.print('/');
+        lcd.printUInt(setMonth, 2, true);
+        lcd.print('/');
+        lcd.printUInt(setYear);
       }
+      // send any screen composed by the caller along with the value
+      lcd.flush();
       blinkText = !blinkText;
       prev = millis();
     }
@@ -369,26 +380,24 @@ bool chArray(const char *iter[], byte bound, byte &setIndex) {
   while (true) {
     // blink array contents at index every 500ms
     if (millis() - prev >= 250) {
-      // buffer for entire line and variables to track length and position
-      char lineBuff[21];
-      int length = strlen(iter[setIndex - 1]);
-      int pos = (20 - length) / 2;
+      // compose entire line as a frame
+      lcd.beginFrame();
+      lcd.setCursor(0, valueY);
 
       if (blinkText){
         // place cursor of size same as value at current index of array at
-        // middle of buffer
-        memset(lineBuff + pos, '\1', length);
+        // middle of line, padding either side with whitespace
+        byte length = strlen(iter[setIndex - 1]);
+        lcd.padTo(layoutCentre(length));
+        lcd.fill('\1', length);
+        lcd.padTo(layoutCols);
       } else {
-        // place value at current index of array at middle of buffer
-        memcpy(lineBuff + pos, iter[setIndex - 1], length);
+        // place value at current index of array at middle of line
+        lcd.printCentered(iter[setIndex - 1], layoutCols);
       }
 
-      // pad either side of value / cursor with whitespace in buffer and print
-      memset(lineBuff, ' ', pos);
-      memset(lineBuff + pos + length, ' ', 20 - (pos + length));
-      lineBuff[20] = 0;
-      lcd.setCursor(0, 2);
-      lcd.print(lineBuff);
+      // print along with any screen composed by the caller
+      lcd.flush();
 
       blinkText = !blinkText;
       prev = millis();
@@ -449,29 +458,28 @@ bool chChallenge(byte &setNum) {
   while (true) {
     // blink challenge every 500ms
     if (millis() - prev >= 250) {
-      // buffer for entire line and variables to track length and position
-      char lineBuff[21];
-      int length = setNum == 0 ? 4 : setNum < 10 ? 1 : 2;
-      int pos = (20 - length) / 2;
+      // compose entire line as a frame, tracking length of challenge
+      byte length = setNum == 0 ? 4 : setNum < 10 ? 1 : 2;
+      lcd.beginFrame();
+      lcd.setCursor(0, valueY);
+      lcd.padTo(layoutCentre(length));
 
       if (blinkText){
         // place cursor of size same as number of digits / letters in challenge
-        // at middle of buffer
-        memset(lineBuff + pos, '\1', length);
+        // at middle of line
+        lcd.fill('\1', length);
       } else if (setNum == 0) {
-        // place NONE if challenge is 0 at middle of buffer
-        memcpy_P(lineBuff + pos, reinterpret_cast<const char *>(F("NONE")), length);
+        // place NONE if challenge is 0 at middle of line
+        lcd.print(F("NONE"));
       } else {
-        // place challenge at middle of buffer
-        sprintf(lineBuff + pos, "%d", setNum);
+        // place challenge at middle of line
+        lcd.printUInt(setNum);
       }
 
-      // pad either side of number / cursor with whitespace in buffer and print
-      memset(lineBuff, ' ', pos);
-      memset(lineBuff + pos + length, ' ', 20 - (pos + length));
-      lineBuff[20] = 0;
-      lcd.setCursor(0, 2);
-      lcd.print(lineBuff);
+      // pad remainder of line with whitespace and print along with any screen
+      // composed by the caller
+      lcd.padTo(layoutCols);
+      lcd.flush();
 
       blinkText = !blinkText;
       prev = millis();
@@ -512,12 +520,14 @@ void confirm() {
        function respectively. This function carries out background tasks when
        idle to ensure automatic brightness is correct and to absorb button
        presses. Used to alert the user that the values have been saved. Nothing
-       is printed on the LCD as text may be specific to the context. LCD is
-       cleared before return.
+       is printed on the LCD as text may be specific to the context, but the
+       confirmation screen composed by the caller is flushed to the LCD first.
+       LCD is cleared before return.
        Parameters: N/A
        Returns: N/A
   */
 
+  lcd.flush();
   background(400);
   digitalWrite(buzzer, LOW); //on
   digitalWrite(blueLED, HIGH);
@@ -548,8 +558,9 @@ void cancel() {
 
   // clear and display LCD message
   lcd.clear();
-  lcd.setCursor(5, 1);
+  lcd.setCursor(layoutCentre(10), messageY);
   lcd.print("CANCELLED!");
+  lcd.flush();
 
   digitalWrite(buzzer, LOW); // on
   digitalWrite(redLED, HIGH);
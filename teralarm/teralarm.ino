@@ -11,6 +11,8 @@
          I2C bus.
        DS3231.h - Library used to interface with the RTC over the I2C bus.
      Local Includes:
+       busHealth.h - Runs the I2C bus in fast mode when the devices allow.
+       customGlyphs.h - Provides the custom LCD characters.
        setInterface.h - Used to create and handle frontend for altering
          settings.
        backgroundTasks.h - Handles brightness related requirements and reads
@@ -19,6 +21,9 @@
          timer.
        clockAlarmInterface.h - Handles the drawing of the clockface and the
          entire alarm procedure.
+       timeKeeping.h - Keeps the shared time object current from the RTC
+         square wave.
+       screenLayout.h - Positions of the boot, title and confirmation text.
 
    (C) RW128k 2022
 */
@@ -28,10 +33,14 @@
 #include <DS3231.h>
 
 #include "BufferedLCD.h"
+#include "busHealth.h"
+#include "customGlyphs.h"
 #include "setInterface.h"
 #include "backgroundTasks.h"
 #include "extendedFunctionality.h"
 #include "clockAlarmInterface.h"
+#include "timeKeeping.h"
+#include "screenLayout.h"
 
 #define button1 2
 #define button2 3
@@ -43,8 +52,21 @@
 #define blueLED 12
 #define ldr A0
 
+// LCD pins when wired directly rather than through the I2C backpack (see
+// lcdParallel in BufferedLCD.h)
+#define lcdRS 6
+#define lcdEnable 9
+#define lcdD4 A1
+#define lcdD5 A2
+#define lcdD6 A3
+#define lcdD7 13
+
 // hardware objects
-BufferedLCD lcd(0x27, 20, 4);
+#if lcdParallel
+BufferedLCD lcd(ParallelBackend(lcdRS, lcdEnable, lcdD4, lcdD5, lcdD6, lcdD7, lcdRows));
+#else
+BufferedLCD lcd(PCF8574Backend(0x27, lcdCols, lcdRows));
+#endif
 DS3231 rtc(SDA, SCL);
 
 // synchronised EEPROM values in RAM
@@ -74,10 +96,13 @@ void setup() {
        Returns: N/A
   */
 
-  // set up hardware objects
+  // set up hardware objects, starting Serial first as the LCD may mirror its
+  // contents over it
+  Serial.begin(9600);
   lcd.begin();
   rtc.begin();
-  Serial.begin(9600);
+  beginBus();
+  beginTime();
   
   // set pin modes for IO
   pinMode(button1, INPUT);
@@ -90,17 +115,9 @@ void setup() {
   pinMode(blueLED, OUTPUT);
   pinMode(ldr, INPUT);
 
-  // create custom LCD characters for blinking cursor and brightness bar
-  byte blinkChar[8] = {0b11111, 0b11111, 0b11111, 0b11111, 0b11111, 0b11111, 0b11111, 0b11111};
-  byte brightBoundL[8] = {0b00011, 0b00011, 0b00011, 0b00011, 0b00011, 0b00011, 0b00011, 0b00011};
-  byte brightFill[8] = {0b00000, 0b11111, 0b11111, 0b11111, 0b11111, 0b11111, 0b11111, 0b00000};
-  byte brightBoundR[8] = {0b11000, 0b11000, 0b11000, 0b11000, 0b11000, 0b11000, 0b11000, 0b11000};
-
-  // add custom LCD characters to LCD object to be used in printing
-  lcd.createChar(1, blinkChar);
-  lcd.createChar(2, brightBoundL);
-  lcd.createChar(3, brightFill);
-  lcd.createChar(4, brightBoundR);
+  // provide custom LCD characters (blinking cursor and brightness bar) to
+  // LCD object to be uploaded as they are printed
+  lcd.setGlyphs(glyphTable);
 
   // set buzzer to off (as it is active low) and LCD to maximum brightness
   digitalWrite(buzzer, HIGH);
@@ -115,23 +132,26 @@ void setup() {
   alarmState = EEPROM.read(5) == 1;
   brightness = EEPROM.read(6) >= 0 && EEPROM.read(6) <= 17 ? EEPROM.read(6) : 0;
 
+  // program the saved alarm into the RTC, discarding any match while off
+  setRtcAlarm(alarmHrs, alarmMins, alarmState);
+
   // set the seed for generating random numbers based on RTC time
-  randomSeed(rtc.getUnixTime(rtc.getTime()));
+  randomSeed(rtc.getUnixTime(timeObj));
 
-  // array of 80 y and x coordinates representing characters on the LCD to be
-  // randomly filled, creating boot animation
-  byte coords[80][2];
+  // array of y and x coordinates representing every character on the LCD (80
+  // on a 20x4 LCD) to be randomly filled, creating boot animation
+  byte coords[layoutCols * layoutRows][2];
   
   // populate the array with coordinates in order left to right, top to bottom
-  for (byte i=0; i<20; i++) {
-    for (byte j=0; j<4; j++) {
-      coords[i*4 + j][0] = j; // y coordinate
-      coords[i*4 + j][1] = i; // x coordinate
+  for (byte i=0; i<layoutCols; i++) {
+    for (byte j=0; j<layoutRows; j++) {
+      coords[i*layoutRows + j][0] = j; // y coordinate
+      coords[i*layoutRows + j][1] = i; // x coordinate
     }
   } 
 
-  // loop over set of 80 unfilled coordinates, reducing set size each iteration
-  for (byte maxi = 80; maxi > 0; maxi--) {
+  // loop over set of unfilled coordinates, reducing set size each iteration
+  for (byte maxi = layoutCols * layoutRows; maxi > 0; maxi--) {
     // select coordinate pair at random from remaining set and fill it on LCD
     byte pos = random(0, maxi);
     lcd.setCursor(coords[pos][1], coords[pos][0]);
@@ -145,14 +165,13 @@ void setup() {
 
   // iterate over each character of title and print it to the LCD every 100ms
   for (byte i = 0; i < 12; i++) {
-    char titleChar[2] = {titleStr[i], 0}; // convert single character to null terminated string
-    lcd.setCursor(4 + i, 1);
-    lcd.print(titleChar);
+    lcd.setCursor(layoutCentre(12) + i, messageY);
+    lcd.print(titleStr[i]);
     delay(i < 11 ? 100 : 200); // pause for 200ms after last character printed
   }
 
   // fill in previously printed title to make completely filled screen
-  lcd.setCursor(4, 1);
+  lcd.setCursor(layoutCentre(12), messageY);
   lcd.print(F("\1\1\1\1\1\1\1\1\1\1\1\1"));
   delay(150);
   
@@ -169,7 +188,7 @@ void setup() {
   
   // print entire title again
   delay(250);
-  lcd.setCursor(4, 1);
+  lcd.setCursor(layoutCentre(12), messageY);
   lcd.print(titleStr);
 
   // only play buzzer sound for 0.5s if no buttons are held
@@ -186,7 +205,7 @@ void setup() {
   digitalWrite(blueLED, LOW);
 
   // print credits line on LCD
-  lcd.setCursor(4, 2);
+  lcd.setCursor(layoutCentre(12), valueY);
   lcd.print(F("-RWGUNN '22-"));
 
   // print credits art, title, time and date over serial
@@ -208,7 +227,11 @@ void setup() {
   lcd.clear();
 
   // send final serial message informing setup has finished
+#if lcdMirror
+  Serial.println(F("THE SYSTEM IS NOW OPERATIONAL. THE LCD WILL BE MIRRORED OVER SERIAL."));
+#else
   Serial.println(F("THE SYSTEM IS NOW OPERATIONAL AND NO FURTHER SERIAL COMMUNICATION WILL BE PROVIDED."));
+#endif
 
   // set the LCD brightness to the users preference: light intensity from LDR
   // if automatic or scaled value if manual all passed through reciprocal
@@ -221,9 +244,10 @@ void setup() {
 
 void loop() {
   /* loop - Standard Arduino main loop function. Called after setup terminates
-       and every time it terminates itself. Checks if the clockface needs to be
-       redrawn, checks if the alarm needs to be triggered and handles all user
-       input / button presses on clockface. Most backend logic for editing time
+       and every time it terminates itself. Redraws the clockface when the RTC
+       second ticks or after another screen has been shown, sounds the alarm
+       when the RTC has flagged it and handles all user input / button
+       presses on clockface. Most backend logic for editing time
        settings, alarm settings and brightness is contained here, while the
        front end (UI) is invoked in this function but its logic is handled by
        source files setInterface and backgroundTasks. Should not be called
@@ -232,43 +256,49 @@ void loop() {
        Returns: N/A
   */
 
-  // variable which stores whether alarm has been disabled in current minute to
-  // stop it triggering directly after being disabled if time is the same
-  static bool alarmDisabled = false;
+  // variable which stores the second last drawn on the clockface, or 0xFF to
+  // repaint it after the LCD has been used by another screen
+  static byte drawnSec = 0xFF;
   
-  // get RTC time and paint / update the clockface every iteration of the loop
-  timeObj = rtc.getTime();
-  updateTime();
+  // advance the cached time and paint / update the clockface only when the
+  // second has ticked, which also picks up temperature changes once per
+  // second. alarm settings only change behind another screen, which forces a
+  // repaint
+  tickTime();
+  if (timeObj.sec != drawnSec) {
+    updateTime();
+    drawnSec = timeObj.sec;
+  }
 
-  // sound alarm if the current time equals the alarm time and it has not been
-  // disabled already in the current minute
-  if (timeObj.hour == alarmHrs && timeObj.min == alarmMins && !alarmDisabled && alarmState) {
+  // sound alarm if the RTC has flagged the alarm time. the flag is cleared
+  // as it is read, so the alarm fires once. it is seen within a second of
+  // the alarm time, or if a menu was open then, as soon as it is left
+  if (rtcAlarmFired() && alarmState) {
     consumePress();
     lcd.clear();
     soundAlarm();
-    // mark alarm as disabled for current minute
-    alarmDisabled = true;
     consumePress();
     lcd.clear();
+    drawnSec = 0xFF;
   }
 
-  // mark alarm as not already disabled if the current time is not the alarm
-  // time and alarm is marked (incorrectly) as disabled for current minute
-  if ((timeObj.hour != alarmHrs || timeObj.min != alarmMins) && alarmDisabled) {alarmDisabled = false;}
-
-  // handle user input and run background tasks on every iteration of loop
-  switch (getPressed()) {
+  // handle user input and run background tasks on every iteration of loop.
+  // every button leaves the clockface for another screen, so repaint it on
+  // the next iteration (including when a setting is cancelled)
+  byte pressed = getPressed();
+  if (pressed != 0) {drawnSec = 0xFF;}
+  switch (pressed) {
     // BUTTON 1: alter time and date
     case 1: {
-      // load current time object into memory to copy from for manipulation
-      timeObj = rtc.getTime();
+      // the time object is current (updated at the start of the loop) so is
+      // copied from for manipulation
 
       /* SET TIME */
 
       // set up UI background on LCD (clear and print title)
       consumePress();
       lcd.clear();
-      lcd.setCursor(5, 0);
+      lcd.setCursor(layoutCentre(9), 0);
       lcd.print(F("SET TIME:"));
 
       // load current hours and minutes into memory for manipulation
@@ -277,15 +307,24 @@ void loop() {
 
       // create UI for altering above time values and run its loop
       if (chTime(setHrs, setMins)) {
-        // update time to altered values on RTC if confirmed
-        rtc.setTime(setHrs, setMins, 0);
+        // update time to altered values on RTC if confirmed, writing the
+        // whole time and date at once with the date brought up to the moment
+        // of confirmation
+        tickTime();
+        Time newTime = timeObj;
+        newTime.hour = setHrs;
+        newTime.min = setMins;
+        newTime.sec = 0;
+        setRtcTime(newTime);
 
         // paint confirmation UI with new time and play buzzer sound
         lcd.clear();
-        lcd.setCursor(4, 1);
+        lcd.setCursor(layoutCentre(12), messageY);
         lcd.print(F("TIME SET TO:"));
-        lcd.setCursor(7, 2);
-        lcd.print(rtc.getTimeStr(FORMAT_SHORT));
+        lcd.setCursor(layoutCentre(5), valueY);
+        lcd.printUInt(setHrs, 2, true);
+        lcd.print(':');
+        lcd.printUInt(setMins, 2, true);
         confirm();    
       } else {
         // paint cancellation UI and play buzzer sound if cancelled
@@ -297,7 +336,7 @@ void loop() {
       /* SET DATE */
 
       // print title on LCD
-      lcd.setCursor(5, 0);
+      lcd.setCursor(layoutCentre(9), 0);
       lcd.print(F("SET DATE:"));
 
       // load current day, month and year into memory for manipulation
@@ -307,15 +346,20 @@ void loop() {
 
       // create UI for altering above date values and run its loop
       if (chDate(setDay, setMonth, setYear)) {
-        // update date to altered values on RTC if confirmed
-        rtc.setDate(setDay, setMonth, setYear);
+        // update date to altered values on RTC if confirmed, leaving the
+        // running time and weekday untouched
+        setRtcDate(setDay, setMonth, setYear);
 
         // paint confirmation UI with new date and play buzzer sound
         lcd.clear();
-        lcd.setCursor(4, 1);
+        lcd.setCursor(layoutCentre(12), messageY);
         lcd.print(F("DATE SET TO:"));
-        lcd.setCursor(5, 2);
-        lcd.print(rtc.getDateStr(FORMAT_LONG, FORMAT_LITTLEENDIAN, '/'));
+        lcd.setCursor(layoutCentre(10), valueY);
+        lcd.printUInt(setDay, 2, true);
+        lcd.print('/');
+        lcd.printUInt(setMonth, 2, true);
+        lcd.print('/');
+        lcd.printUInt(setYear);
         confirm();    
       } else {
         // paint cancellation UI and play buzzer sound if cancelled
@@ -327,7 +371,7 @@ void loop() {
       /* SET WEEKDAY */
 
       // print title on LCD
-      lcd.setCursor(4, 0);
+      lcd.setCursor(layoutCentre(12), 0);
       lcd.print(F("SET WEEKDAY:"));
 
       // load current weekday into memory for manipulation
@@ -335,18 +379,17 @@ void loop() {
 
       // create UI for altering above weekday value and run its loop
       if (chArray(dows, 7, setDow)) {
-        // update weekday to altered value on RTC if confirmed
-        rtc.setDOW(setDow);
+        // update weekday to altered value on RTC if confirmed, leaving the
+        // date (which may have passed midnight meanwhile) untouched
+        setRtcDow(setDow);
 
         // paint confirmation UI with new weekday and play buzzer sound
         lcd.clear();
-        lcd.setCursor(2, 1);
+        lcd.setCursor(layoutCentre(15), messageY);
         lcd.print(F("WEEKDAY SET TO:"));
-        // time object must be recreated to read new weekday from RTC
-        timeObj = rtc.getTime();
-        // numerical to textual weekday: calculate LCD position and print
-        lcd.setCursor(byte((20 - strlen(dows[timeObj.dow - 1])) / 2), 2);
-        lcd.print(dows[timeObj.dow - 1]);
+        // numerical to textual weekday: print centrally
+        lcd.setCursor(0, valueY);
+        lcd.printCentered(dows[setDow - 1], layoutCols);
         confirm();    
       } else {
         // paint cancellation UI and play buzzer sound if cancelled
@@ -362,7 +405,7 @@ void loop() {
       // set up UI background on LCD (clear and print title)
       consumePress();
       lcd.clear();
-      lcd.setCursor(5, 0);
+      lcd.setCursor(layoutCentre(10), 0);
       lcd.print(F("SET ALARM:"));
 
       // copy current alarm hours and minutes to new memory for manipulation
@@ -376,16 +419,16 @@ void loop() {
         alarmMins = setMins;
         EEPROM.update(0, alarmHrs);
         EEPROM.update(1, alarmMins);
+        setRtcAlarm(alarmHrs, alarmMins, alarmState);
 
         // paint confirmation UI with new alarm time and play buzzer sound
         lcd.clear();
-        lcd.setCursor(3, 1);
+        lcd.setCursor(layoutCentre(13), messageY);
         lcd.print(F("ALARM SET TO:"));
-        lcd.setCursor(7, 2);
-        // create buffer and format time string into buffer then print to LCD
-        char confStr[6];
-        sprintf(confStr, "%02d:%02d", alarmHrs, alarmMins);
-        lcd.print(confStr);
+        lcd.setCursor(layoutCentre(5), valueY);
+        lcd.printUInt(alarmHrs, 2, true);
+        lcd.print(':');
+        lcd.printUInt(alarmMins, 2, true);
         confirm();    
       } else {
         // paint cancellation UI and play buzzer sound if cancelled
@@ -397,7 +440,7 @@ void loop() {
       /* SET CHALLENGE */
 
       // print title on LCD
-      lcd.setCursor(3, 0);
+      lcd.setCursor(layoutCentre(14), 0);
       lcd.print(F("SET CHALLENGE:"));
 
       // copy current challenge to new memory for manipulation
@@ -411,18 +454,17 @@ void loop() {
 
         // paint confirmation UI with new challenge and play buzzer sound
         lcd.clear();
-        lcd.setCursor(1, 1);
-        lcd.print(F("CHALLENGE SET TO:"));
-        // create buffer and format challenge into buffer then print to LCD
-        char confStr[5];
+        // the label is shortened on LCDs narrower than it
+        lcd.setCursor(0, messageY);
+        lcd.printCentered(layoutCols >= 17 ? F("CHALLENGE SET TO:") : F("CHALLENGE SET:"), layoutCols);
+        // print challenge or NONE
         if (alarmChallenge == 0) {
-          lcd.setCursor(8, 2);
-          strcpy_P(confStr, reinterpret_cast<const char *>(F("NONE")));
+          lcd.setCursor(layoutCentre(4), valueY);
+          lcd.print(F("NONE"));
         } else {
-          lcd.setCursor(9, 2);
-          sprintf(confStr, "%d", alarmChallenge);
+          lcd.setCursor(layoutCentre(2), valueY);
+          lcd.printUInt(alarmChallenge);
         }
-        lcd.print(confStr);
         confirm();
       } else {
         // paint cancellation UI and play buzzer sound if cancelled
@@ -434,7 +476,7 @@ void loop() {
       /* SET SNOOZE */
 
       // print title on LCD
-      lcd.setCursor(4, 0);
+      lcd.setCursor(layoutCentre(11), 0);
       lcd.print(F("SET SNOOZE:"));
 
       // copy current snooze minutes and seconds to new memory for manipulation
@@ -451,18 +493,19 @@ void loop() {
 
         // paint confirmation UI with new snooze period and play buzzer sound
         lcd.clear();
-        lcd.setCursor(3, 1);
+        lcd.setCursor(layoutCentre(14), messageY);
         lcd.print(F("SNOOZE SET TO:"));
-        // create buffer and format snooze string into buffer then print to LCD
-        char confStr[7];
+        // print snooze period or NONE
         if (alarmSnoozeMins == 0 && alarmSnoozeSecs == 0) {
-          lcd.setCursor(8, 2);
-          strcpy_P(confStr, reinterpret_cast<const char *>(F("NONE")));
+          lcd.setCursor(layoutCentre(4), valueY);
+          lcd.print(F("NONE"));
         } else {
-          lcd.setCursor(7, 2);
-          sprintf(confStr, "%02dm%02ds", alarmSnoozeMins, alarmSnoozeSecs);
+          lcd.setCursor(layoutCentre(6), valueY);
+          lcd.printUInt(alarmSnoozeMins, 2, true);
+          lcd.print('m');
+          lcd.printUInt(alarmSnoozeSecs, 2, true);
+          lcd.print('s');
         }
-        lcd.print(confStr);
         confirm();
       } else {
         // paint cancellation UI and play buzzer sound if cancelled
@@ -474,7 +517,7 @@ void loop() {
       /* SET STATE */
 
       // print title on LCD
-      lcd.setCursor(5, 0);
+      lcd.setCursor(layoutCentre(10), 0);
       lcd.print(F("SET STATE:"));
 
       // copy current state to new memory for manipulation (boolean to integer)
@@ -485,14 +528,15 @@ void loop() {
         // update state to altered value in RAM and EEPROM if confirmed
         alarmState = setState == 2; // integer to boolean (RAM)
         EEPROM.update(5, alarmState ? 1 : 0); // boolean to integer (EEPROM)
+        setRtcAlarm(alarmHrs, alarmMins, alarmState);
 
         // paint confirmation UI with new state and play buzzer sound
         lcd.clear();
-        lcd.setCursor(3, 1);
+        lcd.setCursor(layoutCentre(13), messageY);
         lcd.print(F("STATE SET TO:"));
-        // numerical to textual state: calculate LCD position and print
-        lcd.setCursor(alarmState ? 9 : 8, 2);
-        lcd.print(alarmState ? stateStrs[1] : stateStrs[0]);
+        // numerical to textual state: print centrally
+        lcd.setCursor(0, valueY);
+        lcd.printCentered(alarmState ? stateStrs[1] : stateStrs[0], layoutCols);
         confirm();    
       } else {
         // paint cancellation UI and play buzzer sound if cancelled
@@ -505,9 +549,10 @@ void loop() {
     } case 3: {
       // increase brightness in range 0, 1 -> 17 (AUTO, OFF -> MAX)
       brightness = (brightness + 1) % 18;
-      // if UI function returns true, brightness changed further so call again
+      // if UI function returns true, brightness changed further so call again,
+      // drawing only the changes after the first call
       lcd.clear();
-      while (updateBrightness());
+      for (bool redraw = true; updateBrightness(redraw); redraw = false);
       consumePress();
       lcd.clear();
       break;
@@ -516,9 +561,10 @@ void loop() {
     } case 4:{
       // decrease brightness in range 0, 1 -> 17 (AUTO, OFF -> MAX)
       brightness = (brightness + 17) % 18; // rollunder 0 -> 17
-      // if UI function returns true, brightness changed further so call again
+      // if UI function returns true, brightness changed further so call again,
+      // drawing only the changes after the first call
       lcd.clear();
-      while (updateBrightness());
+      for (bool redraw = true; updateBrightness(redraw); redraw = false);
       consumePress();
       lcd.clear();
       break;
@@ -0,0 +1,672 @@
+/* TERALARM (FIRMWARE 3) - The effective alarm clock
+
+   timeKeeping.cpp - The source file containing the time service, which keeps
+     the shared time object current without reading the RTC on every use. The
+     DS3231 square wave output is set to 1Hz and its falling edge (on which
+     the RTC seconds increment) raises a pin change interrupt, advancing the
+     cached seconds. The RTC is only read to resynchronise when the minute
+     rolls over, or after the time has been set. If no edges arrive (eg SQW
+     is not wired) the seconds are kept from millis instead, scaled by the
+     measured length of an RTC minute on the microcontroller's clock, and the
+     RTC is polled only around the predicted minute rollover to find its
+     moment. Each rollover found exactly (an edge, or a poll closely
+     following one showing the previous minute) measures the drift between
+     the two clocks, which is smoothed over successive minutes. Each read of
+     the RTC is a single burst of its registers 0x00 - 0x12, decoding the
+     time, date, day of week, control / status registers and temperature
+     together, so the temperature and status are also served from memory.
+     The RTC refreshes its temperature registers with an automatic conversion
+     every 64 seconds, which the minute snapshots pick up without any extra
+     reads. A fresh conversion can also be requested through the CONV bit,
+     its result being read once the conversion time has passed. The user's
+     alarm is programmed into Alarm 1 of the RTC, which raises the A1F status
+     flag when it matches. The flag is latched by the RTC and read in the
+     snapshot taken at each minute rollover (started by the SQW edge). If the
+     flag is not yet set in the snapshot of the alarm minute, the status
+     register alone is read again once the RTC is past second 00, so the
+     alarm is seen within a second of its time rather than a minute later. A
+     flag raised while the loop is busy in a menu stays latched and is seen
+     at the first rollover after the menu is left. New times and dates are
+     written to the RTC in single bursts from the values already in memory,
+     which also become the cached time without a read.
+     External Variables / Constants:
+       rtc - Hardware object representing RTC.
+       timeObj - Shared current Date / Time object across sources.
+     Third Party Includes:
+       Arduino.h - The main Arduino library containing all platform specific
+         functions and constants.
+       DS3231.h - Library used to interface with the RTC over the I2C bus.
+       Wire.h - Arduino library used to burst read the RTC registers.
+     Local Includes:
+       timeKeeping.h - Own header file.
+
+   (C) RW128k 2024
+*/
+
+#include <Arduino.h>
+#include <Wire.h>
+
+#include "timeKeeping.h"
+
+// I2C address of the RTC and number of registers read in each snapshot
+// (seconds through to the temperature LSB)
+#define rtcAddress 0x68
+#define snapshotLength 0x13
+
+// CONV bit of the control register and BSY bit of the status register, and
+// the time a temperature conversion may take (ms)
+#define ctrlConv 0x20
+#define statBusy 0x04
+#define convTime 200
+
+// A1F bit of the status register, set when Alarm 1 matches
+#define statAlarm1 0x01
+
+// pin wired to the open drain SQW output of the RTC. must be on port D, as
+// the interrupt is handled by the port D pin change vector below
+#define rtcSqwPin 7
+
+// time without an edge after which the square wave is treated as missing,
+// and the interval at which the RTC is polled around a rollover
+#define sqwSilence 1500
+#define pollInterval 50
+
+// time before the predicted minute rollover at which polling starts, wide
+// until the drift has been measured from an exact rollover
+#define wideGuard 1000
+#define narrowGuard 150
+
+// largest difference (ms) between a measured minute and 60 seconds which is
+// accepted as drift rather than a missed rollover (2%)
+#define driftLimit 1200
+
+// file-scoped globals for the edges counted by the interrupt (wide enough not
+// to wrap while a menu leaves the count unread) and the input register / bit
+// of the SQW pin it reads
+static volatile unsigned int pendingTicks = 0;
+static volatile unsigned long lastEdge = 0;
+static volatile uint8_t *sqwInput;
+static uint8_t sqwMask;
+
+// file-scoped globals to record the last and total number of RTC reads, and
+// the number of failed RTC transactions
+static unsigned long lastSync = 0;
+static unsigned long syncs = 0;
+static unsigned long errors = 0;
+
+// file-scoped globals for the software clock: the millis at which the cached
+// minute began (and whether it was found exactly), the length of an RTC
+// minute in microseconds of the microcontroller's clock, the number of
+// minutes measured and whether the RTC is being polled for the rollover
+static unsigned long anchor = 0;
+static bool anchorExact = false;
+static unsigned long minuteMicros = 60000000;
+static byte measured = 0;
+static bool polling = false;
+
+// file-scoped globals for the control, status and temperature registers of
+// the last snapshot, the temperature held in quarter degrees
+static byte control = 0;
+static byte status = 0;
+static int tempQuarters = 0;
+
+// file-scoped globals for the time Alarm 1 is programmed for (hour 0xFF when
+// disabled) and whether its flag is to be read again in the alarm minute
+static byte alarmHour = 0xFF;
+static byte alarmMin = 0;
+static bool alarmRecheck = false;
+
+// file-scoped globals to record whether a requested temperature conversion
+// is running and when it was started (or its completion last checked)
+static bool converting = false;
+static unsigned long convertStart = 0;
+
+ISR(PCINT2_vect) {
+  /* PCINT2_vect - Interrupt service routine for pin changes on port D, which
+       counts the falling edges of the SQW output as seconds ticked by the RTC.
+       Rising edges (half a second later) are ignored.
+       Parameters: N/A
+       Returns: N/A
+  */
+
+  if (!(*sqwInput & sqwMask)) {
+    pendingTicks++;
+    lastEdge = millis();
+  }
+}
+
+static byte fromBCD(byte value) {
+  /* fromBCD - Function which converts a binary coded decimal register value
+       to binary.
+       Parameters:
+         value - The BCD value, tens in the upper nibble.
+       Returns: Byte holding the binary value.
+  */
+
+  return (value >> 4) * 10 + (value & 0x0F);
+}
+
+static byte toBCD(byte value) {
+  /* toBCD - Function which converts a binary value (0 - 99) to binary coded
+       decimal for writing to a register.
+       Parameters:
+         value - The binary value.
+       Returns: Byte holding the BCD value, tens in the upper nibble.
+  */
+
+  return ((value / 10) << 4) | (value % 10);
+}
+
+static bool endWrite() {
+  /* endWrite - Function which sends a transmission to the RTC, counting it as
+       failed if it is not acknowledged.
+       Parameters: N/A
+       Returns: Boolean which is true if the transmission was acknowledged.
+  */
+
+  if (Wire.endTransmission() == 0) {return true;}
+  errors++;
+  return false;
+}
+
+static bool readRegisters(byte first, byte *regs, byte count) {
+  /* readRegisters - Function which reads consecutive RTC registers in a single
+       I2C transaction.
+       Parameters:
+         first - The address of the first register.
+         regs - Pointer to the array to read the registers into.
+         count - The number of registers to read.
+       Returns: Boolean which is true if all of the registers were read.
+  */
+
+  // point the RTC at the first register and read on from it
+  Wire.beginTransmission(rtcAddress);
+  Wire.write(first);
+  if (!endWrite()) {return false;}
+  if (Wire.requestFrom(uint8_t(rtcAddress), count) != count) {
+    errors++;
+    return false;
+  }
+  for (byte i = 0; i < count; i++) {regs[i] = Wire.read();}
+  return true;
+}
+
+static int decodeTemp(byte msb, byte lsb) {
+  /* decodeTemp - Function which converts the RTC temperature registers to
+       quarter degrees.
+       Parameters:
+         msb - The temperature MSB register, whole degrees (two's complement).
+         lsb - The temperature LSB register, quarters in the top 2 bits.
+       Returns: Integer holding the temperature in quarter degrees C.
+  */
+
+  return int8_t(msb) * 4 + (lsb >> 6);
+}
+
+static bool readSnapshot() {
+  /* readSnapshot - Function which reads RTC registers 0x00 - 0x12 in a single
+       I2C transaction and decodes them into the shared time object and the
+       control, status and temperature globals. Nothing is changed if the read
+       fails, leaving the last snapshot in place.
+       Parameters: N/A
+       Returns: Boolean which is true if the registers were read.
+  */
+
+  byte regs[snapshotLength];
+  if (!readRegisters(0x00, regs, snapshotLength)) {return false;}
+
+  // decode time, allowing for the RTC having been left in 12 hour mode
+  timeObj.sec = fromBCD(regs[0x00] & 0x7F);
+  timeObj.min = fromBCD(regs[0x01] & 0x7F);
+  if (regs[0x02] & 0x40) {
+    timeObj.hour = fromBCD(regs[0x02] & 0x1F) % 12 + (regs[0x02] & 0x20 ? 12 : 0);
+  } else {
+    timeObj.hour = fromBCD(regs[0x02] & 0x3F);
+  }
+
+  // decode date, ignoring the century bit as the library does
+  timeObj.dow = regs[0x03] & 0x07;
+  timeObj.date = fromBCD(regs[0x04] & 0x3F);
+  timeObj.mon = fromBCD(regs[0x05] & 0x1F);
+  timeObj.year = 2000 + fromBCD(regs[0x06]);
+
+  // keep control, status and temperature
+  control = regs[0x0E];
+  status = regs[0x0F];
+  tempQuarters = decodeTemp(regs[0x11], regs[0x12]);
+
+  // the flag may be set just after the rollover is read, so read it again
+  // later in the alarm minute if it is not yet set
+  alarmRecheck = timeObj.hour == alarmHour && timeObj.min == alarmMin && !(status & statAlarm1);
+  return true;
+}
+
+static void checkAlarm() {
+  /* checkAlarm - Function which reads the status register again in the alarm
+       minute if the snapshot of the rollover did not have the Alarm 1 flag
+       set, once the RTC is past second 00 so the match has certainly
+       happened. Only one extra read is made each time.
+       Parameters: N/A
+       Returns: N/A
+  */
+
+  if (!alarmRecheck || timeObj.sec == 0) {return;}
+  alarmRecheck = false;
+
+  byte regs[1];
+  if (readRegisters(0x0F, regs, 1)) {status = regs[0];}
+}
+
+static void checkConversion() {
+  /* checkConversion - Function which reads the result of a requested
+       temperature conversion once the conversion time has passed. The
+       control register through to the temperature are read together, and
+       if the CONV bit has not yet cleared the check is repeated after
+       another conversion time.
+       Parameters: N/A
+       Returns: N/A
+  */
+
+  if (!converting || millis() - convertStart < convTime) {return;}
+  convertStart = millis();
+
+  // control, status, aging offset, temperature MSB and LSB
+  byte regs[5];
+  if (!readRegisters(0x0E, regs, 5)) {return;}
+  control = regs[0];
+  status = regs[1];
+  if (control & ctrlConv) {return;}
+
+  tempQuarters = decodeTemp(regs[3], regs[4]);
+  converting = false;
+}
+
+static void readTime() {
+  /* readTime - Function which reads a snapshot of the RTC, discarding the
+       edges counted before the read as the RTC time already includes them.
+       If an edge arrives during the read it is unclear which side of it the
+       time was read, so the read is repeated (edges are a second apart, so at
+       most once).
+       Parameters: N/A
+       Returns: N/A
+  */
+
+  for (byte attempt = 0; attempt < 2; attempt++) {
+    noInterrupts();
+    pendingTicks = 0;
+    interrupts();
+
+    readSnapshot();
+    syncs++;
+
+    if (pendingTicks == 0) {break;}
+  }
+
+  // an edge in the second read is counted as a tick on the next call
+  lastSync = millis();
+}
+
+static void rollover(unsigned long boundary, bool exact) {
+  /* rollover - Function which starts a new cached minute at a rollover of the
+       RTC. If both this and the previous rollover were found exactly, the
+       time between them is the length of an RTC minute on the
+       microcontroller's clock, which is taken outright the first time and
+       smoothed into the existing measurement after. Implausible lengths (eg
+       a rollover missed while a menu ran) are ignored.
+       Parameters:
+         boundary - The millis at which the rollover happened (or is estimated
+           to have happened).
+         exact - Boolean which is true if the boundary was found exactly.
+       Returns: N/A
+  */
+
+  unsigned long length = boundary - anchor;
+  if (exact && anchorExact && length > 60000 - driftLimit && length < 60000 + driftLimit) {
+    long error = (long) (length * 1000) - (long) minuteMicros;
+    minuteMicros += measured == 0 ? error : error / 4;
+    if (measured < 255) {measured++;}
+  }
+
+  anchor = boundary;
+  anchorExact = exact;
+}
+
+static bool extrapolate() {
+  /* extrapolate - Function which advances the cached seconds from millis,
+       scaled by the measured length of an RTC minute, while there is no
+       square wave. Close to the predicted rollover the RTC is polled instead
+       until the minute changes, resynchronising the whole time and finding
+       the moment of the rollover to within half the poll interval.
+       Parameters: N/A
+       Returns: Boolean which is true if the time has changed.
+  */
+
+  unsigned long now = millis();
+  unsigned long elapsed = now - anchor;
+  unsigned long guard = measured > 0 && anchorExact ? narrowGuard : wideGuard;
+
+  // poll the RTC at a limited rate once the rollover is close
+  if (elapsed + guard >= minuteMicros / 1000) {
+    if (now - lastSync < pollInterval) {return false;}
+
+    // the rollover is exact if the previous poll (showing the old minute)
+    // was no more than a poll interval late, and is taken as halfway between
+    // the two polls
+    bool exact = polling && now - lastSync < 2 * pollInterval;
+    unsigned long boundary = lastSync + (now - lastSync) / 2;
+    byte min = timeObj.min;
+    byte sec = timeObj.sec;
+    readTime();
+
+    // keep polling until the minute changes
+    if (timeObj.min == min) {
+      polling = true;
+      return timeObj.sec != sec;
+    }
+
+    // otherwise start the new minute, estimating its start as the middle
+    // of the second read if it was missed
+    polling = false;
+    if (exact && timeObj.sec == 0) {
+      rollover(boundary, true);
+    } else {
+      rollover(now - timeObj.sec * 1000UL - 500, false);
+    }
+    return true;
+  }
+
+  // advance the seconds to those elapsed since the start of the minute
+  unsigned long secondMicros = minuteMicros / 60;
+  byte sec = timeObj.sec;
+  while (timeObj.sec < 59 && elapsed >= (timeObj.sec + 1) * secondMicros / 1000) {timeObj.sec++;}
+  return timeObj.sec != sec;
+}
+
+void beginTime() {
+  /* beginTime - Function which sets the RTC square wave output to 1Hz, enables
+       the pin change interrupt on its pin and reads the current time. Should
+       be called after the RTC has been initialised.
+       Parameters: N/A
+       Returns: N/A
+  */
+
+  rtc.setOutput(OUTPUT_SQW);
+  rtc.setSQWRate(SQW_RATE_1);
+
+  // SQW is open drain so needs the pull up
+  pinMode(rtcSqwPin, INPUT_PULLUP);
+  sqwInput = portInputRegister(digitalPinToPort(rtcSqwPin));
+  sqwMask = digitalPinToBitMask(rtcSqwPin);
+  *digitalPinToPCMSK(rtcSqwPin) |= _BV(digitalPinToPCMSKbit(rtcSqwPin));
+  *digitalPinToPCICR(rtcSqwPin) |= _BV(digitalPinToPCICRbit(rtcSqwPin));
+
+  syncTime();
+}
+
+void syncTime() {
+  /* syncTime - Function which reads the time from the RTC into the shared
+       time object. The start of the cached minute is estimated from the
+       seconds read, until the next rollover is found.
+       Parameters: N/A
+       Returns: N/A
+  */
+
+  readTime();
+  polling = false;
+  rollover(millis() - timeObj.sec * 1000UL, false);
+}
+
+void setRtcTime(const Time &time) {
+  /* setRtcTime - Function which writes all seven timekeeping registers of the
+       RTC (seconds through to year) in a single I2C transaction, so the RTC
+       cannot roll over between partial writes. Writing the seconds restarts
+       the RTC's second, so the new minute is taken to start now (less the
+       seconds written) and the time becomes the cached time without a read.
+       Parameters:
+         time - The time and date to set (year 2000 - 2099, 24 hour).
+       Returns: N/A
+  */
+
+  Wire.beginTransmission(rtcAddress);
+  Wire.write(uint8_t(0x00));
+  Wire.write(toBCD(time.sec));
+  Wire.write(toBCD(time.min));
+  Wire.write(toBCD(time.hour));
+  Wire.write(time.dow);
+  Wire.write(toBCD(time.date));
+  Wire.write(toBCD(time.mon));
+  Wire.write(toBCD(time.year - 2000));
+  if (!endWrite()) {return;}
+
+  // discard edges of the old second, as syncTime does
+  noInterrupts();
+  pendingTicks = 0;
+  interrupts();
+
+  timeObj = time;
+  polling = false;
+  rollover(millis() - time.sec * 1000UL, false);
+}
+
+void setRtcDate(byte date, byte mon, short year) {
+  /* setRtcDate - Function which writes the date, month and year registers of
+       the RTC in a single I2C transaction, leaving the running time (and the
+       phase of its seconds) and the day of week untouched, and updates the
+       cached date to match.
+       Parameters:
+         date - A byte representing the day of the month (1 - 31).
+         mon - A byte representing the month (1 - 12).
+         year - A short representing the year (2000 - 2099).
+       Returns: N/A
+  */
+
+  Wire.beginTransmission(rtcAddress);
+  Wire.write(uint8_t(0x04));
+  Wire.write(toBCD(date));
+  Wire.write(toBCD(mon));
+  Wire.write(toBCD(year - 2000));
+  if (!endWrite()) {return;}
+
+  timeObj.date = date;
+  timeObj.mon = mon;
+  timeObj.year = year;
+}
+
+void setRtcDow(byte dow) {
+  /* setRtcDow - Function which writes the day of week register of the RTC
+       alone, leaving the time and date untouched (so a midnight passed while
+       choosing it is kept), and updates the cached day of week to match.
+       Parameters:
+         dow - A byte representing the day of week (1 - 7).
+       Returns: N/A
+  */
+
+  Wire.beginTransmission(rtcAddress);
+  Wire.write(uint8_t(0x03));
+  Wire.write(dow);
+  if (!endWrite()) {return;}
+
+  timeObj.dow = dow;
+}
+
+bool tickTime() {
+  /* tickTime - Function which advances the shared time object by the seconds
+       ticked since the last call, reading the RTC only when the minute rolls
+       over (as the minutes, hours and date may all change). Falls back to the
+       software clock when the square wave is missing. Should be called on
+       every iteration of a loop which shows or compares the time, and while
+       waiting for a requested temperature conversion.
+       Parameters: N/A
+       Returns: Boolean which is true if the time has changed.
+  */
+
+  // pick up the result of a requested temperature conversion and a late
+  // alarm flag
+  checkConversion();
+  checkAlarm();
+
+  // take the edges counted since the last call
+  noInterrupts();
+  unsigned int ticks = pendingTicks;
+  pendingTicks = 0;
+  unsigned long edge = lastEdge;
+  interrupts();
+
+  // keep time from millis while there are no edges
+  if (millis() - edge > sqwSilence) {return extrapolate();}
+
+  if (ticks == 0) {return false;}
+
+  // advance the seconds, or resynchronise when the minute rolls over. the
+  // last edge is exactly the rollover if no seconds were skipped past it
+  if (timeObj.sec + ticks >= 60) {
+    rollover(edge, timeObj.sec + ticks == 60);
+    readTime();
+  } else {
+    timeObj.sec += ticks;
+  }
+  return true;
+}
+
+unsigned long rtcErrors() {
+  /* rtcErrors - Function which gives the number of failed transactions with
+       the RTC since startup.
+       Parameters: N/A
+       Returns: Unsigned long holding the number of failures.
+  */
+
+  return errors;
+}
+
+unsigned long timeSyncs() {
+  /* timeSyncs - Function which gives the number of times the RTC has been read
+       by the time service since startup.
+       Parameters: N/A
+       Returns: Unsigned long holding the number of reads.
+  */
+
+  return syncs;
+}
+
+float rtcTemp() {
+  /* rtcTemp - Function which gives the temperature from the last snapshot of
+       the RTC.
+       Parameters: N/A
+       Returns: Float holding the temperature in degrees C, to 0.25 degrees.
+         At most 64 seconds old (the automatic conversion interval) unless a
+         conversion has been requested.
+  */
+
+  return tempQuarters / 4.0;
+}
+
+void setRtcAlarm(byte hour, byte min, bool enabled) {
+  /* setRtcAlarm - Function which programs Alarm 1 of the RTC to match once a
+       day at the given time (seconds 00), and clears any alarm already
+       flagged. A disabled alarm is set to match day of month 0, which never
+       occurs. Should be called whenever the alarm settings are changed.
+       Parameters:
+         hour - The hour of the alarm (0 - 23).
+         min - The minute of the alarm (0 - 59).
+         enabled - Boolean which is true if the alarm should fire.
+       Returns: N/A
+  */
+
+  // write seconds, minutes and hours (BCD, 24 hour, mask bits clear) and the
+  // day / date register (A1M4 set to ignore the date when enabled)
+  Wire.beginTransmission(rtcAddress);
+  Wire.write(uint8_t(0x07));
+  Wire.write(uint8_t(0x00));
+  Wire.write(toBCD(min));
+  Wire.write(toBCD(hour));
+  Wire.write(uint8_t(enabled ? 0x80 : 0x00));
+  endWrite();
+  alarmHour = enabled ? hour : 0xFF;
+  alarmMin = min;
+  alarmRecheck = false;
+
+  // clear the flag so that a match from the old settings does not fire
+  byte regs[1];
+  if (!readRegisters(0x0F, regs, 1)) {return;}
+  status = regs[0] & ~statAlarm1;
+  Wire.beginTransmission(rtcAddress);
+  Wire.write(uint8_t(0x0F));
+  Wire.write(status);
+  endWrite();
+}
+
+bool rtcAlarmFired() {
+  /* rtcAlarmFired - Function which checks whether the last snapshot of the
+       RTC flagged Alarm 1, clearing the flag on the RTC if so, so that each
+       match is reported once.
+       Parameters: N/A
+       Returns: Boolean which is true if the alarm has fired.
+  */
+
+  if (!(status & statAlarm1)) {return false;}
+
+  status &= ~statAlarm1;
+  Wire.beginTransmission(rtcAddress);
+  Wire.write(uint8_t(0x0F));
+  Wire.write(status);
+  endWrite();
+  return true;
+}
+
+void convertTemp() {
+  /* convertTemp - Function which requests a fresh temperature conversion by
+       setting the CONV bit, unless a conversion (automatic or requested) is
+       already running, in which case its result is waited for instead. The
+       result is read by tickTime once the conversion has had time to finish.
+       Parameters: N/A
+       Returns: N/A
+  */
+
+  if (converting) {return;}
+
+  // check for a running conversion before setting CONV
+  byte regs[2];
+  if (!readRegisters(0x0E, regs, 2)) {return;}
+  control = regs[0];
+  status = regs[1];
+  if (!(control & ctrlConv) && !(status & statBusy)) {
+    Wire.beginTransmission(rtcAddress);
+    Wire.write(uint8_t(0x0E));
+    Wire.write(uint8_t(control | ctrlConv));
+    if (!endWrite()) {return;}
+  }
+
+  converting = true;
+  convertStart = millis();
+}
+
+byte rtcControl() {
+  /* rtcControl - Function which gives the control register (0x0E) from the
+       last snapshot of the RTC.
+       Parameters: N/A
+       Returns: Byte holding the register value.
+  */
+
+  return control;
+}
+
+byte rtcStatus() {
+  /* rtcStatus - Function which gives the status register (0x0F) from the last
+       snapshot of the RTC.
+       Parameters: N/A
+       Returns: Byte holding the register value.
+  */
+
+  return status;
+}
+
+long timeDrift() {
+  /* timeDrift - Function which gives the measured drift of the
+       microcontroller's clock against the RTC.
+       Parameters: N/A
+       Returns: Long holding the drift in parts per million, positive when
+         millis runs fast.
+  */
+
+  return ((long) minuteMicros - 60000000L) / 60;
+}
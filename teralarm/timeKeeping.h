@@ -0,0 +1,54 @@
+/* TERALARM (FIRMWARE 3) - The effective alarm clock
+
+   timeKeeping.h - The header file containing the time service, which keeps
+     the shared time object current without reading the RTC on every use. The
+     DS3231 square wave output is set to 1Hz and its falling edge (on which
+     the RTC seconds increment) raises a pin change interrupt, advancing the
+     cached seconds. The RTC is only read to resynchronise when the minute
+     rolls over, or after the time has been set. If no edges arrive (eg SQW
+     is not wired) the seconds are kept from millis instead, corrected for
+     the drift measured against the RTC at each minute rollover. The RTC is
+     read in single burst snapshots which also hold its temperature and
+     control / status registers. A fresh temperature conversion can be
+     requested between the RTC's automatic conversions (every 64 seconds).
+     The alarm is offloaded to Alarm 1 of the RTC, its flag being picked up
+     from the snapshots. Times and dates are set in single burst writes.
+     External Variables / Constants:
+       rtc - Hardware object representing RTC.
+       timeObj - Shared current Date / Time object across sources.
+     Third Party Includes:
+       Arduino.h - The main Arduino library containing all platform specific
+         functions and constants.
+       DS3231.h - Library used to interface with the RTC over the I2C bus.
+       Wire.h - Arduino library used to burst read the RTC registers.
+     Local Includes:
+       timeKeeping.h - Own header file.
+
+   (C) RW128k 2024
+*/
+
+#ifndef TIMEKEEPING_H
+#define TIMEKEEPING_H
+
+#include <DS3231.h>
+
+extern DS3231 rtc;
+extern Time timeObj;
+
+void beginTime();
+void syncTime();
+void setRtcTime(const Time &time);
+void setRtcDate(byte date, byte mon, short year);
+void setRtcDow(byte dow);
+bool tickTime();
+unsigned long timeSyncs();
+unsigned long rtcErrors();
+long timeDrift();
+float rtcTemp();
+void convertTemp();
+void setRtcAlarm(byte hour, byte min, bool enabled);
+bool rtcAlarmFired();
+byte rtcControl();
+byte rtcStatus();
+
+#endif
@@ -0,0 +1,106 @@
+/* TERALARM (FIRMWARE 3) - The effective alarm clock
+
+   Arduino.cpp - The file containing the host shim of the Arduino core. Every
+     read of the virtual clock moves it on by a few microseconds, standing in
+     for the time the firmware spends between reads, so polling loops which
+     wait on millis end.
+     External Variables / Constants: N/A
+     Third Party Includes: N/A
+     Local Includes:
+       Arduino.h - Own header file.
+       EEPROM.h - Host model of the EEPROM, defined here.
+
+   (C) RW128k 2024
+*/
+
+#include "Arduino.h"
+#include "EEPROM.h"
+
+// time taken by the firmware between reads of the clock (us)
+#define readMicros 10
+
+volatile uint8_t SREG = 0;
+volatile uint8_t PCICR = 0, PCMSK2 = 0, PIND = 0xFF, DDRD = 0;
+volatile uint8_t hostPorts[20] = {0};
+
+unsigned long hostMicros = 0;
+void (*hostClockHook)() = NULL;
+uint8_t hostPins[20] = {HIGH, HIGH, HIGH, HIGH, HIGH, HIGH, HIGH, HIGH, HIGH, HIGH, HIGH, HIGH, HIGH, HIGH, HIGH, HIGH, HIGH, HIGH, HIGH, HIGH};
+int hostAnalog = 512;
+
+HardwareSerial Serial;
+EEPROMClass EEPROM;
+
+unsigned long micros() {
+  hostMicros += readMicros;
+  if (hostClockHook != NULL) {hostClockHook();}
+  return hostMicros;
+}
+
+unsigned long millis() {
+  return micros() / 1000;
+}
+
+void delay(unsigned long ms) {
+  hostMicros += ms * 1000;
+  if (hostClockHook != NULL) {hostClockHook();}
+}
+
+void delayMicroseconds(unsigned int us) {
+  hostMicros += us;
+  if (hostClockHook != NULL) {hostClockHook();}
+}
+
+void noInterrupts() {}
+void interrupts() {}
+
+void pinMode(uint8_t pin, uint8_t mode) {}
+
+int digitalRead(uint8_t pin) {
+  return pin < 20 ? hostPins[pin] : LOW;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {}
+
+int analogRead(uint8_t pin) {
+  return hostAnalog;
+}
+
+void analogWrite(uint8_t pin, int value) {}
+void tone(uint8_t pin, unsigned int frequency) {}
+void noTone(uint8_t pin) {}
+
+long random(long low, long high) {
+  return high > low ? low + rand() % (high - low) : low;
+}
+
+void randomSeed(unsigned long seed) {
+  srand(seed);
+}
+
+char *dtostrf(double value, signed char width, unsigned char precision, char *out) {
+  sprintf(out, "%*.*f", width, precision, value);
+  return out;
+}
+
+char *ultoa(unsigned long value, char *out, int radix) {
+  snprintf(out, 11, radix == 16 ? "%lx" : "%lu", value);
+  return out;
+}
+
+size_t Print::write(const uint8_t *buffer, size_t size) {
+  for (size_t i = 0; i < size; i++) {write(buffer[i]);}
+  return size;
+}
+
+size_t Print::print(long value) {
+  char digits[12];
+  snprintf(digits, sizeof(digits), "%ld", value);
+  return write(digits);
+}
+
+size_t Print::print(unsigned long value) {
+  char digits[12];
+  snprintf(digits, sizeof(digits), "%lu", value);
+  return write(digits);
+}
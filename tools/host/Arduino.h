@@ -0,0 +1,142 @@
+/* TERALARM (FIRMWARE 3) - The effective alarm clock
+
+   Arduino.h - The header file containing the host shim of the Arduino core,
+     which lets the firmware modules be built and run on a PC for tests and
+     benchmarks. Program memory is ordinary memory, the AVR registers used by
+     the firmware are plain variables and time is a virtual clock which only
+     moves when the firmware reads it, waits or uses the I2C bus, so runs are
+     repeatable and a simulated day takes well under a second. Pins are an
+     array the harness can set (eg to press buttons or drive the SQW pin), and
+     Serial output is discarded. A harness which drives the firmware from the
+     inside of its loops (eg pressing buttons while a menu waits) can set a
+     hook which is run whenever the clock moves. Each pin has its own output
+     register, so a harness can read the pins driven through the registers
+     (eg by the parallel LCD backend).
+     External Variables / Constants:
+       hostMicros - The virtual clock in microseconds.
+       hostClockHook - Function run after the clock moves, or NULL.
+       hostPins - The level read from each digital pin.
+       hostPorts - The output register of each digital pin.
+       hostAnalog - The value read from the analog pins.
+     Third Party Includes: N/A
+     Local Includes: N/A
+
+   (C) RW128k 2024
+*/
+
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+// program memory is ordinary memory on the host
+class __FlashStringHelper;
+#define PROGMEM
+#define PSTR(s) (s)
+#define F(s) (reinterpret_cast<const __FlashStringHelper *>(PSTR(s)))
+#define strlen_P strlen
+#define memcmp_P memcmp
+#define memcpy_P memcpy
+#define strcpy_P strcpy
+#define strcat_P strcat
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define pgm_read_word(p) (*(const uint16_t *)(p))
+#define pgm_read_ptr(p) (*(void *const *)(p))
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define A0 14
+#define A1 15
+#define A2 16
+#define A3 17
+#define SDA 18
+#define SCL 19
+
+#ifndef max
+#define max(a, b) ((a) > (b) ? (a) : (b))
+#endif
+#ifndef min
+#define min(a, b) ((a) < (b) ? (a) : (b))
+#endif
+
+// AVR registers and interrupt vectors, every pin sharing port D's input and
+// mode registers but having an output register of its own
+extern volatile uint8_t SREG;
+extern volatile uint8_t PCICR, PCMSK2, PIND, DDRD;
+extern volatile uint8_t hostPorts[20];
+#define _BV(b) (1 << (b))
+#define ISR(vector) extern "C" void vector(void)
+#define cli() noInterrupts()
+#define sei() interrupts()
+#define digitalPinToPort(p) (p)
+#define digitalPinToBitMask(p) ((uint8_t) (1 << ((p) & 7)))
+#define portOutputRegister(p) (&hostPorts[p])
+#define portInputRegister(p) (&PIND)
+#define portModeRegister(p) (&DDRD)
+#define digitalPinToPCICR(p) (&PCICR)
+#define digitalPinToPCICRbit(p) (2)
+#define digitalPinToPCMSK(p) (&PCMSK2)
+#define digitalPinToPCMSKbit(p) ((p) & 7)
+
+extern unsigned long hostMicros;
+extern void (*hostClockHook)();
+extern uint8_t hostPins[20];
+extern int hostAnalog;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void noInterrupts();
+void interrupts();
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t value);
+int analogRead(uint8_t pin);
+void analogWrite(uint8_t pin, int value);
+void tone(uint8_t pin, unsigned int frequency);
+void noTone(uint8_t pin);
+long random(long low, long high);
+void randomSeed(unsigned long seed);
+char *dtostrf(double value, signed char width, unsigned char precision, char *out);
+char *ultoa(unsigned long value, char *out, int radix);
+
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t value) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size);
+    size_t write(const char *string) {return write((const uint8_t *) string, strlen(string));}
+    size_t print(const __FlashStringHelper *string) {return write(reinterpret_cast<const char *>(string));}
+    size_t print(const char *string) {return write(string);}
+    size_t print(char character) {return write(uint8_t(character));}
+    size_t print(long value);
+    size_t print(unsigned long value);
+    size_t print(int value) {return print(long(value));}
+    size_t print(unsigned int value) {return print((unsigned long) value);}
+    size_t println() {return write("\r\n");}
+    template <class T> size_t println(T value) {return print(value) + println();}
+};
+
+class HardwareSerial : public Print {
+public:
+    void begin(unsigned long baud) {}
+    size_t write(uint8_t value) {return 1;}
+    using Print::write;
+    int availableForWrite() {return 63;}
+};
+
+extern HardwareSerial Serial;
+
+#endif
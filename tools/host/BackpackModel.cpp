@@ -0,0 +1,164 @@
+/* TERALARM (FIRMWARE 3) - The effective alarm clock
+
+   BackpackModel.cpp - The file containing a model of an HD44780 LCD on a
+     PCF8574 I2C backpack.
+     External Variables / Constants:
+       glyphTable - Table of custom characters, to identify those shown.
+     Third Party Includes: N/A
+     Local Includes:
+       BackpackModel.h - Own header file.
+       customGlyphs.h - Table of custom characters.
+
+   (C) RW128k 2024
+*/
+
+#include "BackpackModel.h"
+#include "customGlyphs.h"
+
+// outputs of the backpack wired to the controller
+#define pcfRS 0x01
+#define pcfRW 0x02
+#define pcfEnable 0x04
+
+BackpackModel::BackpackModel(uint8_t cols, uint8_t rows)
+: memory(0xFF) {
+  /* Constructor which records the size of the display and starts the
+       controller in 8 bit mode, as at power on.
+       Parameters:
+         cols - A byte representing the number of columns of the display.
+         rows - A byte representing the number of rows of the display.
+  */
+
+  this->cols = cols;
+  this->rows = rows;
+  outputs = 0;
+  fourBit = false;
+  lowNibble = false;
+  highNibble = 0;
+}
+
+void BackpackModel::receive(const uint8_t *data, uint8_t length) {
+  /* receive - Method which takes a write to the backpack, latching a nibble
+       into the controller on each falling edge of enable (unless reading).
+       Parameters:
+         data - Pointer to the bytes written.
+         length - The number of bytes written.
+       Returns: N/A
+  */
+
+  for (uint8_t i = 0; i < length; i++) {
+    bool falling = (outputs & pcfEnable) && !(data[i] & pcfEnable) && !(outputs & pcfRW);
+    uint8_t nibble = outputs & 0xF0;
+    bool rs = outputs & pcfRS;
+    outputs = data[i];
+    if (falling) {latch(nibble, rs);}
+  }
+}
+
+void BackpackModel::latch(uint8_t nibble, bool rs) {
+  /* latch - Method which takes a nibble latched by the controller, either
+       from the backpack or from pins driven directly.
+       Parameters:
+         nibble - A byte holding the data lines in its upper 4 bits.
+         rs - Boolean which is true if register select was high (data).
+       Returns: N/A
+  */
+
+  // in 8 bit mode (during initialisation) a nibble is a whole instruction
+  // with the lower data lines low, which may switch to 4 bit mode
+  if (!fourBit) {
+    if (!rs && nibble == 0x20) {fourBit = true;}
+    memory.transferByte(nibble, rs);
+    return;
+  }
+
+  // in 4 bit mode the high nibble is followed by the low nibble
+  if (!lowNibble) {
+    highNibble = nibble;
+    lowNibble = true;
+    return;
+  }
+  lowNibble = false;
+  memory.transferByte(highNibble | (nibble >> 4), rs);
+}
+
+uint8_t BackpackModel::transmit(uint8_t *data, uint8_t length) {
+  /* transmit - Method which answers a read of the backpack with all outputs
+       low, so the busy flag reads clear.
+       Parameters:
+         data - Pointer to the bytes to read into.
+         length - The number of bytes requested.
+       Returns: The number of bytes read.
+  */
+
+  memset(data, 0, length);
+  return length;
+}
+
+void BackpackModel::line(uint8_t y, char *out) {
+  /* line - Method which gives the characters shown on a row of the display,
+       custom characters being given as the ID of the glyph they hold (or '?'
+       if it is not in the glyph table).
+       Parameters:
+         y - A byte representing the row.
+         out - Pointer to an array to write the row into, which must hold the
+           number of columns and a terminator.
+       Returns: N/A
+  */
+
+  for (uint8_t x = 0; x < cols; x++) {
+    uint8_t code = memory.visible(x, y, cols);
+    if (code < 0x10) {
+      const uint8_t *bitmap = memory.cgram + (code & 0x07) * 8;
+      code = '?';
+      for (uint8_t id = 1; id < 0x20; id++) {
+        const uint8_t *glyph = reinterpret_cast<const uint8_t *>(pgm_read_ptr(glyphTable + id));
+        if (glyph != NULL && memcmp(glyph, bitmap, 8) == 0) {
+          code = id;
+          break;
+        }
+      }
+    }
+    out[x] = code;
+  }
+  out[cols] = '\0';
+}
+
+void BackpackModel::print(FILE *out) {
+  /* print - Method which prints the display inside a border, custom
+       characters and the degree symbol being shown by similar looking
+       characters as in tools/lcdMirror.py.
+       Parameters:
+         out - The stream to print to.
+       Returns: N/A
+  */
+
+  static const char *const glyphs[0x18] = {
+    "?", "█", "▐", "▬", "▌", "?", "?", "?",
+    "?", "?", "?", "?", "?", "?", "?", "?",
+    "▔", "▁", "▏", "▕", "┌", "┐", "└", "┘"
+  };
+
+  fputc('+', out);
+  for (uint8_t x = 0; x < cols; x++) {fputc('-', out);}
+  fputs("+\n", out);
+  for (uint8_t y = 0; y < rows; y++) {
+    char text[41];
+    line(y, text);
+    fputc('|', out);
+    for (uint8_t x = 0; x < cols; x++) {
+      uint8_t code = text[x];
+      if (code < 0x18) {
+        fputs(glyphs[code], out);
+      } else if (code == 0xDF) {
+        fputs("°", out);
+      } else {
+        fputc(code >= 0x20 && code < 0x7F ? code : '?', out);
+      }
+    }
+    fputs("|\n", out);
+  }
+  fputc('+', out);
+  for (uint8_t x = 0; x < cols; x++) {fputc('-', out);}
+  fputs("+\n", out);
+}
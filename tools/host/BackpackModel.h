@@ -0,0 +1,52 @@
+/* TERALARM (FIRMWARE 3) - The effective alarm clock
+
+   BackpackModel.h - The header file containing a model of an HD44780 LCD on
+     a PCF8574 I2C backpack, for running the firmware's screens on the host.
+     Each byte written to the backpack sets its 8 outputs (register select,
+     read/write, enable and backlight on the lower 4, the data lines on the
+     upper 4), and a nibble is latched by the controller when enable falls.
+     Nibbles are taken as whole instructions until the controller is switched
+     to 4 bit mode, then paired into bytes, which are decoded into display
+     and character memory by a framebuffer backend. Reads return the busy
+     flag clear. Nibbles may also be latched directly, for an LCD wired to
+     GPIO pins rather than the backpack. The screen can be printed as text,
+     with custom characters shown by the glyph they hold.
+     External Variables / Constants: N/A
+     Third Party Includes:
+       Arduino.h - Host shim of the Arduino core.
+       Wire.h - Host model of the I2C bus.
+     Local Includes:
+       FramebufferBackend.h - Model of the HD44780 memory.
+
+   (C) RW128k 2024
+*/
+
+#ifndef BACKPACKMODEL_H
+#define BACKPACKMODEL_H
+
+#include <Arduino.h>
+#include <Wire.h>
+
+#include "FramebufferBackend.h"
+
+class BackpackModel : public HostDevice {
+public:
+    BackpackModel(uint8_t cols, uint8_t rows);
+    void receive(const uint8_t *data, uint8_t length);
+    uint8_t transmit(uint8_t *data, uint8_t length);
+    void latch(uint8_t nibble, bool rs);
+    void line(uint8_t y, char *out);
+    void print(FILE *out);
+
+    FramebufferBackend memory;
+
+private:
+    uint8_t cols;
+    uint8_t rows;
+    uint8_t outputs;
+    bool fourBit;
+    bool lowNibble;
+    uint8_t highNibble;
+};
+
+#endif
@@ -0,0 +1,197 @@
+/* TERALARM (FIRMWARE 3) - The effective alarm clock
+
+   DS3231.cpp - The file containing the host model of the DS3231 RTC and of
+     the Rinky-Dink Electronics DS3231 library.
+     External Variables / Constants: N/A
+     Third Party Includes: N/A
+     Local Includes:
+       DS3231.h - Own header file.
+
+   (C) RW128k 2024
+*/
+
+#include "DS3231.h"
+
+HostRtc hostRtc;
+
+static uint8_t fromBCD(uint8_t value) {
+  return (value >> 4) * 10 + (value & 0x0F);
+}
+
+static uint8_t toBCD(uint8_t value) {
+  return ((value / 10) << 4) | (value % 10);
+}
+
+static uint8_t monthDays(uint8_t mon, uint16_t year) {
+  /* monthDays - Function which gives the number of days in a month.
+       Parameters:
+         mon - The month (1 -> 12).
+         year - The year, for February.
+       Returns: The number of days.
+  */
+
+  static const uint8_t days[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+  if (mon == 2 && year % 4 == 0) {return 29;}
+  return days[mon - 1];
+}
+
+Time::Time() {
+  hour = 0;
+  min = 0;
+  sec = 0;
+  date = 1;
+  mon = 1;
+  year = 2000;
+  dow = 6;
+}
+
+HostRtc::HostRtc() {
+  /* HostRtc - Constructor which starts the RTC at midnight on 1 January 2024
+       (a Monday) at 21.25C, with the oscillator running and the square wave
+       enabled.
+       Parameters: N/A
+       Returns: N/A
+  */
+
+  memset(regs, 0, sizeof(regs));
+  Time time;
+  time.year = 2024;
+  time.dow = 1;
+  set(time);
+  regs[0x11] = 21;
+  regs[0x12] = 0x40;
+  pointer = 0;
+  convertStart = 0;
+}
+
+void HostRtc::receive(const uint8_t *data, uint8_t length) {
+  /* receive - Method which takes a write from the bus, the first byte
+       setting the register pointer and the rest being written from it. The
+       status flags can only be cleared, as on the hardware.
+       Parameters:
+         data - Pointer to the bytes written.
+         length - The number of bytes written.
+       Returns: N/A
+  */
+
+  if (length == 0) {return;}
+  pointer = data[0] % sizeof(regs);
+  for (uint8_t i = 1; i < length; i++) {
+    if (pointer == 0x0F) {
+      regs[0x0F] = (data[i] & 0xFC) | (regs[0x0F] & data[i] & 0x03);
+    } else {
+      regs[pointer] = data[i];
+    }
+    if (pointer == 0x0E && (data[i] & 0x20)) {convertStart = hostMicros;}
+    pointer = (pointer + 1) % sizeof(regs);
+  }
+}
+
+uint8_t HostRtc::transmit(uint8_t *data, uint8_t length) {
+  /* transmit - Method which answers a read from the bus with the registers
+       from the register pointer on, wrapping to 0x00 after 0x12. A requested
+       temperature conversion is finished first if it has had time to.
+       Parameters:
+         data - Pointer to the array to read the registers into.
+         length - The number of registers to read.
+       Returns: The number of registers read.
+  */
+
+  if ((regs[0x0E] & 0x20) && hostMicros - convertStart >= 200000) {regs[0x0E] &= ~0x20;}
+  for (uint8_t i = 0; i < length; i++) {
+    data[i] = regs[pointer];
+    pointer = (pointer + 1) % sizeof(regs);
+  }
+  return length;
+}
+
+void HostRtc::set(const Time &time) {
+  regs[0x00] = toBCD(time.sec);
+  regs[0x01] = toBCD(time.min);
+  regs[0x02] = toBCD(time.hour);
+  regs[0x03] = time.dow;
+  regs[0x04] = toBCD(time.date);
+  regs[0x05] = toBCD(time.mon);
+  regs[0x06] = toBCD(time.year - 2000);
+}
+
+Time HostRtc::get() {
+  Time time;
+  time.sec = fromBCD(regs[0x00]);
+  time.min = fromBCD(regs[0x01]);
+  time.hour = fromBCD(regs[0x02] & 0x3F);
+  time.dow = regs[0x03];
+  time.date = fromBCD(regs[0x04]);
+  time.mon = fromBCD(regs[0x05] & 0x1F);
+  time.year = 2000 + fromBCD(regs[0x06]);
+  return time;
+}
+
+void HostRtc::tick() {
+  /* tick - Method which advances the time by a second, carrying into the
+       date, and sets the Alarm 1 flag if the new time matches the alarm
+       registers (seconds, minutes and hours, or also the date when A1M4 is
+       clear).
+       Parameters: N/A
+       Returns: N/A
+  */
+
+  Time time = get();
+  if (++time.sec == 60) {
+    time.sec = 0;
+    if (++time.min == 60) {
+      time.min = 0;
+      if (++time.hour == 24) {
+        time.hour = 0;
+        time.dow = time.dow % 7 + 1;
+        if (++time.date > monthDays(time.mon, time.year)) {
+          time.date = 1;
+          if (++time.mon == 13) {
+            time.mon = 1;
+            time.year++;
+          }
+        }
+      }
+    }
+  }
+  set(time);
+
+  bool match = regs[0x07] == regs[0x00] && (regs[0x08] & 0x7F) == regs[0x01] && (regs[0x09] & 0x3F) == regs[0x02];
+  if (match && ((regs[0x0A] & 0x80) || (regs[0x0A] & 0x3F) == regs[0x04])) {regs[0x0F] |= 0x01;}
+}
+
+void DS3231::begin() {
+  Wire.attach(0x68, &hostRtc);
+}
+
+char *DS3231::getTimeStr(uint8_t format) {
+  static char output[12];
+  Time time = hostRtc.get();
+  if (format == FORMAT_SHORT) {
+    snprintf(output, sizeof(output), "%02u:%02u", time.hour, time.min);
+  } else {
+    snprintf(output, sizeof(output), "%02u:%02u:%02u", time.hour, time.min, time.sec);
+  }
+  return output;
+}
+
+char *DS3231::getDateStr(uint8_t slFormat, uint8_t eFormat, char divider) {
+  static char output[16];
+  Time time = hostRtc.get();
+  snprintf(output, sizeof(output), "%02u%c%02u%c%04u", time.date, divider, time.mon, divider, time.year);
+  return output;
+}
+
+long DS3231::getUnixTime(Time time) {
+  /* getUnixTime - Method which converts a time to seconds since the start of
+       1970.
+       Parameters:
+         time - The time to convert.
+       Returns: The number of seconds.
+  */
+
+  long days = time.date - 1;
+  for (uint16_t year = 1970; year < time.year; year++) {days += year % 4 == 0 ? 366 : 365;}
+  for (uint8_t mon = 1; mon < time.mon; mon++) {days += monthDays(mon, time.year);}
+  return ((days * 24 + time.hour) * 60 + time.min) * 60L + time.sec;
+}
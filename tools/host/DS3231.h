@@ -0,0 +1,77 @@
+/* TERALARM (FIRMWARE 3) - The effective alarm clock
+
+   DS3231.h - The header file containing the host model of the DS3231 RTC and
+     of the parts of the Rinky-Dink Electronics DS3231 library used by the
+     firmware. The RTC model holds registers 0x00 - 0x12, which are read and
+     written over the modelled I2C bus at address 0x68 as on the hardware.
+     The harness ticks it once a second, when it also raises the Alarm 1
+     flag on a match. Temperature conversions complete 200ms after they are
+     requested.
+     External Variables / Constants:
+       hostRtc - The RTC on the bus.
+     Third Party Includes:
+       Arduino.h - Host shim of the Arduino core.
+       Wire.h - Host model of the I2C bus.
+     Local Includes: N/A
+
+   (C) RW128k 2024
+*/
+
+#ifndef DS3231_H
+#define DS3231_H
+
+#include <Arduino.h>
+#include <Wire.h>
+
+#define FORMAT_SHORT 1
+#define FORMAT_LONG 2
+#define FORMAT_LITTLEENDIAN 1
+#define FORMAT_BIGENDIAN 2
+#define FORMAT_MIDDLEENDIAN 3
+#define OUTPUT_SQW 0
+#define OUTPUT_INT 1
+#define SQW_RATE_1 0
+
+class Time {
+public:
+    uint8_t hour;
+    uint8_t min;
+    uint8_t sec;
+    uint8_t date;
+    uint8_t mon;
+    uint16_t year;
+    uint8_t dow;
+
+    Time();
+};
+
+class HostRtc : public HostDevice {
+public:
+    HostRtc();
+    void receive(const uint8_t *data, uint8_t length);
+    uint8_t transmit(uint8_t *data, uint8_t length);
+    void set(const Time &time);
+    Time get();
+    void tick();
+
+    uint8_t regs[0x13];
+
+private:
+    uint8_t pointer;
+    unsigned long convertStart;
+};
+
+class DS3231 {
+public:
+    DS3231(uint8_t sda, uint8_t scl) {}
+    void begin();
+    void setOutput(uint8_t output) {}
+    void setSQWRate(int rate) {}
+    char *getTimeStr(uint8_t format = FORMAT_LONG);
+    char *getDateStr(uint8_t slFormat = FORMAT_LONG, uint8_t eFormat = FORMAT_LITTLEENDIAN, char divider = '.');
+    long getUnixTime(Time time);
+};
+
+extern HostRtc hostRtc;
+
+#endif
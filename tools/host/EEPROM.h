@@ -0,0 +1,32 @@
+/* TERALARM (FIRMWARE 3) - The effective alarm clock
+
+   EEPROM.h - The header file containing the host model of the Arduino EEPROM
+     library, 1KB of memory erased to 0xFF as on a new ATmega328P.
+     External Variables / Constants:
+       EEPROM - The EEPROM, defined in Arduino.cpp.
+     Third Party Includes:
+       Arduino.h - Host shim of the Arduino core.
+     Local Includes: N/A
+
+   (C) RW128k 2024
+*/
+
+#ifndef EEPROM_H
+#define EEPROM_H
+
+#include <Arduino.h>
+
+class EEPROMClass {
+public:
+    EEPROMClass() {memset(cells, 0xFF, sizeof(cells));}
+    uint8_t read(int address) {return cells[address & 0x3FF];}
+    void write(int address, uint8_t value) {cells[address & 0x3FF] = value;}
+    void update(int address, uint8_t value) {write(address, value);}
+
+private:
+    uint8_t cells[1024];
+};
+
+extern EEPROMClass EEPROM;
+
+#endif
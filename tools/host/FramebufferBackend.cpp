@@ -0,0 +1,132 @@
+/* TERALARM (FIRMWARE 3) - The effective alarm clock
+
+   FramebufferBackend.cpp - The file containing a backend for the buffered
+     LCD which models the memory of an HD44780 on the host.
+     External Variables / Constants: N/A
+     Third Party Includes: N/A
+     Local Includes:
+       FramebufferBackend.h - Own header file.
+
+   (C) RW128k 2024
+*/
+
+#include "FramebufferBackend.h"
+
+FramebufferBackend::FramebufferBackend(uint8_t batchLength) {
+  /* Constructor which records the number of bytes which fit in a batch and
+       initialises the modelled memory as the controller powers up.
+       Parameters:
+         batchLength - A byte representing the number of bytes in a batch.
+  */
+
+  this->batchLength = batchLength;
+  beginDisplay();
+}
+
+void FramebufferBackend::beginDisplay() {
+  /* beginDisplay - Method which models the initialisation of the controller,
+       which clears the display memory and leaves the address counter at 0.
+       Character memory is filled with a pattern which no glyph uses, so a
+       slot read before it is uploaded is noticed. The counters are reset.
+       Parameters: N/A
+       Returns: N/A
+  */
+
+  memset(ddram, ' ', sizeof(ddram));
+  memset(cgram, 0xAA, sizeof(cgram));
+  addressCounter = 0;
+  addressingCGRAM = false;
+  transferLength = 0;
+  resetCounters();
+}
+
+void FramebufferBackend::resetCounters() {
+  transfers = 0;
+  addressInstructions = 0;
+  longestTransfer = 0;
+}
+
+void FramebufferBackend::beginTransfer() {
+  transferLength = 0;
+}
+
+void FramebufferBackend::transferByte(uint8_t value, bool data) {
+  /* transferByte - Method which decodes a byte sent to the controller,
+       starting a new batch first if the open one is full.
+       Parameters:
+         value - A byte representing the character or instruction.
+         data - Boolean which is true for character data, false for
+           instructions.
+       Returns: N/A
+  */
+
+  if (transferLength == batchLength) {
+    endTransfer();
+    transferLength = 0;
+  }
+  transferLength++;
+
+  // characters are written at the address counter, which then moves on,
+  // wrapping between the lines of display memory
+  if (data) {
+    if (addressingCGRAM) {
+      cgram[addressCounter] = value & 0x1F;
+      addressCounter = (addressCounter + 1) & 0x3F;
+      return;
+    }
+    ddram[addressCounter] = value;
+    addressCounter++;
+    if (addressCounter == 0x28) {
+      addressCounter = 0x40;
+    } else if (addressCounter == 0x68) {
+      addressCounter = 0x00;
+    }
+    return;
+  }
+
+  // only clear and the address instructions change the memory or counter
+  if (value & 0x80) {
+    addressCounter = value & 0x7F;
+    addressingCGRAM = false;
+    addressInstructions++;
+  } else if (value & 0x40) {
+    addressCounter = value & 0x3F;
+    addressingCGRAM = true;
+    addressInstructions++;
+  } else if (value == 0x01) {
+    memset(ddram, ' ', sizeof(ddram));
+    addressCounter = 0;
+    addressingCGRAM = false;
+  }
+}
+
+void FramebufferBackend::endTransfer() {
+  /* endTransfer - Method which counts the open batch as sent, if it holds
+       anything.
+       Parameters: N/A
+       Returns: N/A
+  */
+
+  if (transferLength == 0) {return;}
+  transfers++;
+  if (transferLength > longestTransfer) {longestTransfer = transferLength;}
+  transferLength = 0;
+}
+
+uint8_t FramebufferBackend::transferRoom() {
+  return batchLength - transferLength;
+}
+
+uint8_t FramebufferBackend::visible(uint8_t x, uint8_t y, uint8_t cols) {
+  /* visible - Method which gives the code shown at a position of the
+       display, which for 4 line displays continues the first and second
+       lines of memory on the third and fourth.
+       Parameters:
+         x - A byte representing the column.
+         y - A byte representing the row (0 -> 3).
+         cols - A byte representing the width of the display.
+       Returns: The character code in display memory at the position.
+  */
+
+  return ddram[(y % 2 == 0 ? 0x00 : 0x40) + (y >= 2 ? cols : 0) + x];
+}
@@ -0,0 +1,53 @@
+/* TERALARM (FIRMWARE 3) - The effective alarm clock
+
+   FramebufferBackend.h - The header file containing a backend for the
+     buffered LCD which models the memory of an HD44780 on the host instead of
+     driving hardware, for testing what the LCD is actually sent. Instructions
+     and characters are decoded as the controller does in 2 line mode: the
+     address counter is set by DDRAM and CGRAM address instructions and
+     incremented after each character, DDRAM wrapping from the end of the
+     first line (0x27) to the start of the second (0x40) and from the end of
+     the second (0x67) back to 0x00. Batches are limited to a set number of
+     bytes (6 by default, as fit in an I2C transmission to the backpack) and
+     are split when full, as the PCF8574 backend does. The batches and
+     address instructions sent are counted for checking how the LCD is
+     driven.
+     External Variables / Constants: N/A
+     Third Party Includes:
+       Arduino.h - Host shim of the Arduino core.
+     Local Includes: N/A
+
+   (C) RW128k 2024
+*/
+
+#ifndef FRAMEBUFFERBACKEND_H
+#define FRAMEBUFFERBACKEND_H
+
+#include <Arduino.h>
+
+class FramebufferBackend {
+public:
+    FramebufferBackend(uint8_t batchLength = 6);
+    void beginDisplay();
+    void beginTransfer();
+    void transferByte(uint8_t value, bool data);
+    void endTransfer();
+    uint8_t transferRoom();
+
+    uint8_t visible(uint8_t x, uint8_t y, uint8_t cols);
+    void resetCounters();
+
+    uint8_t ddram[0x80];
+    uint8_t cgram[0x40];
+    uint8_t addressCounter;
+    bool addressingCGRAM;
+    unsigned long transfers;
+    unsigned long addressInstructions;
+    uint8_t longestTransfer;
+
+private:
+    uint8_t batchLength;
+    uint8_t transferLength;
+};
+
+#endif
@@ -0,0 +1,28 @@
+/* TERALARM (FIRMWARE 3) - The effective alarm clock
+
+   LiquidCrystal_I2C.h - The header file containing the host stand in for the
+     LiquidCrystal_I2C library, which the PCF8574 backend only uses as a
+     fallback initialisation when the busy flag cannot be read. The modelled
+     backpacks always answer the busy flag, so it does nothing.
+     External Variables / Constants: N/A
+     Third Party Includes:
+       Arduino.h - Host shim of the Arduino core.
+       Wire.h - Host model of the I2C bus.
+     Local Includes: N/A
+
+   (C) RW128k 2024
+*/
+
+#ifndef LIQUIDCRYSTAL_I2C_H
+#define LIQUIDCRYSTAL_I2C_H
+
+#include <Arduino.h>
+#include <Wire.h>
+
+class LiquidCrystal_I2C {
+public:
+    LiquidCrystal_I2C(uint8_t addr, uint8_t cols, uint8_t rows, uint8_t charsize = 0) {}
+    void begin() {}
+};
+
+#endif
@@ -0,0 +1,108 @@
+/* TERALARM (FIRMWARE 3) - The effective alarm clock
+
+   Wire.cpp - The file containing the host model of the Arduino I2C library.
+     External Variables / Constants: N/A
+     Third Party Includes: N/A
+     Local Includes:
+       Wire.h - Own header file.
+
+   (C) RW128k 2024
+*/
+
+#include "Wire.h"
+
+TwoWire Wire;
+
+TwoWire::TwoWire() {
+  memset(devices, 0, sizeof(devices));
+  resetCounters();
+  length = 0;
+  position = 0;
+  clock = 100000;
+}
+
+void TwoWire::setClock(uint32_t clock) {
+  this->clock = clock;
+}
+
+void TwoWire::attach(uint8_t address, HostDevice *device) {
+  /* attach - Method which places a device model on the bus.
+       Parameters:
+         address - The 7 bit address the device responds to.
+         device - A pointer to the device model, or NULL to remove it.
+       Returns: N/A
+  */
+
+  devices[address & 0x7F] = device;
+}
+
+void TwoWire::resetCounters() {
+  memset(transactions, 0, sizeof(transactions));
+  memset(bytes, 0, sizeof(bytes));
+}
+
+void TwoWire::busTime(uint8_t length) {
+  /* busTime - Method which counts a transaction of the given number of data
+       bytes to the current address, and moves the virtual clock on by the
+       time it takes on the bus.
+       Parameters:
+         length - The number of data bytes, not including the address.
+       Returns: N/A
+  */
+
+  transactions[address]++;
+  bytes[address] += length + 1;
+  hostMicros += ((length + 1) * 9UL + 2) * 1000000UL / clock;
+}
+
+void TwoWire::beginTransmission(uint8_t address) {
+  this->address = address & 0x7F;
+  length = 0;
+}
+
+size_t TwoWire::write(uint8_t value) {
+  if (length >= BUFFER_LENGTH) {return 0;}
+  buffer[length++] = value;
+  return 1;
+}
+
+uint8_t TwoWire::endTransmission(bool stop) {
+  /* endTransmission - Method which delivers the buffered bytes to the device
+       at the address of the transmission.
+       Parameters:
+         stop - Unused, the bus is always released.
+       Returns: 0 if the device acknowledged, 2 if there is no device at the
+         address.
+  */
+
+  busTime(length);
+  if (devices[address] == NULL) {return 2;}
+  devices[address]->receive(buffer, length);
+  return 0;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity, uint8_t stop) {
+  /* requestFrom - Method which reads bytes from a device into the buffer, to
+       be taken with read.
+       Parameters:
+         address - The 7 bit address of the device.
+         quantity - The number of bytes to read.
+         stop - Unused, the bus is always released.
+       Returns: The number of bytes read, 0 if there is no device.
+  */
+
+  this->address = address & 0x7F;
+  if (quantity > BUFFER_LENGTH) {quantity = BUFFER_LENGTH;}
+  busTime(quantity);
+  length = devices[this->address] == NULL ? 0 : devices[this->address]->transmit(buffer, quantity);
+  position = 0;
+  return length;
+}
+
+int TwoWire::available() {
+  return length - position;
+}
+
+int TwoWire::read() {
+  return position < length ? buffer[position++] : -1;
+}
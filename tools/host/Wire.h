@@ -0,0 +1,65 @@
+/* TERALARM (FIRMWARE 3) - The effective alarm clock
+
+   Wire.h - The header file containing the host model of the Arduino I2C
+     library. Transmissions are delivered to the device models attached at
+     their addresses, and are not acknowledged where no device is attached.
+     The bus time of each transaction (9 clocks a byte plus start and stop) is
+     added to the virtual clock, and the transactions and bytes (including
+     the address byte) to each address are counted for benchmarks.
+     External Variables / Constants:
+       Wire - The bus.
+     Third Party Includes:
+       Arduino.h - Host shim of the Arduino core.
+     Local Includes: N/A
+
+   (C) RW128k 2024
+*/
+
+#ifndef WIRE_H
+#define WIRE_H
+
+#include <Arduino.h>
+
+#define BUFFER_LENGTH 32
+#define WIRE_HAS_TIMEOUT 1
+
+class HostDevice {
+public:
+    virtual ~HostDevice() {}
+    virtual void receive(const uint8_t *data, uint8_t length) = 0;
+    virtual uint8_t transmit(uint8_t *data, uint8_t length) = 0;
+};
+
+class TwoWire : public Print {
+public:
+    TwoWire();
+    void begin() {}
+    void setClock(uint32_t clock);
+    void setWireTimeout(uint32_t timeout = 25000, bool reset = false) {}
+    void beginTransmission(uint8_t address);
+    uint8_t endTransmission(bool stop = true);
+    uint8_t requestFrom(uint8_t address, uint8_t quantity, uint8_t stop = 1);
+    size_t write(uint8_t value);
+    using Print::write;
+    int available();
+    int read();
+
+    void attach(uint8_t address, HostDevice *device);
+    void resetCounters();
+    unsigned long transactions[128];
+    unsigned long bytes[128];
+
+private:
+    void busTime(uint8_t length);
+
+    HostDevice *devices[128];
+    uint8_t address;
+    uint8_t buffer[BUFFER_LENGTH];
+    uint8_t length;
+    uint8_t position;
+    uint32_t clock;
+};
+
+extern TwoWire Wire;
+
+#endif
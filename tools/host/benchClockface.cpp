@@ -0,0 +1,143 @@
+/* TERALARM (FIRMWARE 3) - The effective alarm clock
+
+   benchClockface.cpp - The benchmark which replays 24 hours of the clockface
+     on the host and reports the I2C traffic it causes. Each simulated second
+     the RTC model ticks and drives a falling edge on the SQW pin, then the
+     work of the loop for that second is run as on the hardware: the cached
+     time is advanced, the clockface is drawn and the buttons are polled
+     until the LCD changes have been sent in the background. The LCD traffic
+     is taken from the counters of the PCF8574 backend and the RTC traffic
+     from the modelled bus, both including address bytes. With nosqw the
+     SQW pin is left idle, replaying the fallback which keeps the seconds
+     from millis and polls the RTC around each minute rollover.
+     Usage: benchClockface [hours] [nosqw]
+     External Variables / Constants: N/A
+     Third Party Includes:
+       Arduino.h - Host shim of the Arduino core.
+       Wire.h - Host model of the I2C bus.
+       DS3231.h - Host model of the RTC.
+     Local Includes:
+       backgroundTasks.h - Polls the buttons and sends LCD changes.
+       clockAlarmInterface.h - Draws the clockface.
+       customGlyphs.h - Table of custom characters.
+       timeKeeping.h - Keeps the shared time object current.
+
+   (C) RW128k 2024
+*/
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <DS3231.h>
+
+#include "backgroundTasks.h"
+#include "clockAlarmInterface.h"
+#include "customGlyphs.h"
+#include "timeKeeping.h"
+
+// pin the SQW output of the RTC is wired to (see timeKeeping.cpp)
+#define rtcSqwPin 7
+
+extern "C" void PCINT2_vect(void);
+
+class HostBackpack : public HostDevice {
+public:
+    void receive(const uint8_t *data, uint8_t length) {}
+    uint8_t transmit(uint8_t *data, uint8_t length) {
+      memset(data, 0, length);
+      return length;
+    }
+};
+
+static void waitUntil(unsigned long micros) {
+  /* waitUntil - Function which moves the virtual clock on to a time, unless
+       it has already passed.
+       Parameters:
+         micros - The virtual time to move to.
+       Returns: N/A
+  */
+
+  if (long(micros - hostMicros) > 0) {hostMicros = micros;}
+}
+
+static void sqwEdge(bool level) {
+  /* sqwEdge - Function which drives the SQW pin to a level and runs the pin
+       change interrupt.
+       Parameters:
+         level - Boolean which is true for the rising edge.
+       Returns: N/A
+  */
+
+  if (level) {
+    PIND |= digitalPinToBitMask(rtcSqwPin);
+  } else {
+    PIND &= ~digitalPinToBitMask(rtcSqwPin);
+  }
+  PCINT2_vect();
+}
+
+int main(int argc, char **argv) {
+  unsigned long seconds = (argc > 1 ? strtoul(argv[1], NULL, 10) : 24) * 3600;
+  bool sqw = argc < 3 || strcmp(argv[2], "nosqw") != 0;
+
+  // start up as setup does, with the alarm set for 07:30
+  HostBackpack backpack;
+  Wire.attach(0x27, &backpack);
+  lcd.begin();
+  rtc.begin();
+  beginTime();
+  lcd.setGlyphs(glyphTable);
+  alarmHrs = 7;
+  alarmMins = 30;
+  alarmState = true;
+  setRtcAlarm(alarmHrs, alarmMins, alarmState);
+  updateTime();
+  lcd.flush();
+
+  // count only the traffic of the replay
+  unsigned long lcdTransactions = lcd.i2cTransactions();
+  unsigned long lcdBytes = lcd.i2cBytes();
+  unsigned long lcdMicros = lcd.i2cMicros();
+  Wire.resetCounters();
+  unsigned long start = hostMicros;
+  unsigned long draws = 0;
+  unsigned long alarmSecond = 0;
+
+  for (unsigned long second = 1; second <= seconds; second++) {
+    // the RTC ticks on the falling edge, half a second after the rising edge
+    waitUntil(start + second * 1000000UL - 500000UL);
+    if (sqw) {sqwEdge(true);}
+    waitUntil(start + second * 1000000UL);
+    hostRtc.tick();
+    if (sqw) {sqwEdge(false);}
+
+    // run the loop until the changed clockface has been sent
+    if (tickTime()) {
+      updateTime();
+      draws++;
+    }
+    if (rtcAlarmFired() && alarmSecond == 0) {alarmSecond = second;}
+    unsigned long sent;
+    do {
+      sent = lcd.i2cTransactions();
+      getPressed();
+    } while (lcd.i2cTransactions() != sent);
+  }
+
+  lcdTransactions = lcd.i2cTransactions() - lcdTransactions;
+  lcdBytes = lcd.i2cBytes() - lcdBytes;
+  lcdMicros = lcd.i2cMicros() - lcdMicros;
+  double hours = seconds / 3600.0;
+  printf("replayed %.1f hours %s SQW (%lu clockface draws, %lu RTC syncs)\n", hours, sqw ? "with" : "without", draws, timeSyncs());
+  printf("%-6s %14s %12s %10s %12s\n", "device", "transactions", "bytes", "bytes/s", "bus ms/s");
+  printf("%-6s %14lu %12lu %10.1f %12.3f\n", "LCD", lcdTransactions, lcdBytes, double(lcdBytes) / seconds, lcdMicros / 1000.0 / seconds);
+  printf("%-6s %14lu %12lu %10.1f %12.3f\n", "RTC", Wire.transactions[0x68], Wire.bytes[0x68], double(Wire.bytes[0x68]) / seconds, Wire.bytes[0x68] * 9 / 100.0 / seconds);
+  if (alarmSecond != 0) {printf("alarm seen %lu seconds after 07:30:00\n", alarmSecond - (7 * 60 + 30) * 60);}
+
+  // the clock must not have drifted from the RTC over the replay
+  Time rtcTime = hostRtc.get();
+  if (rtcTime.hour != timeObj.hour || rtcTime.min != timeObj.min || rtcTime.sec != timeObj.sec) {
+    printf("FAIL: clockface shows %02u:%02u:%02u, RTC is at %02u:%02u:%02u\n", timeObj.hour, timeObj.min, timeObj.sec, rtcTime.hour, rtcTime.min, rtcTime.sec);
+    return 1;
+  }
+  return 0;
+}
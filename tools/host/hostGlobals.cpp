@@ -0,0 +1,46 @@
+/* TERALARM (FIRMWARE 3) - The effective alarm clock
+
+   hostGlobals.cpp - The file containing the globals shared by the firmware
+     modules, which are defined in teralarm.ino on the hardware. The harness
+     programs are built from the firmware modules without the sketch, so
+     these definitions must be kept the same as those in teralarm.ino.
+     External Variables / Constants:
+       lcd - Hardware object representing LCD.
+       rtc - Hardware object representing RTC.
+       alarmMins, alarmHrs, alarmChallenge, alarmSnoozeSecs, alarmSnoozeMins,
+         alarmState, brightness - The settings, set by the harness.
+       timeObj - Shared current Date / Time object across sources.
+       dows, months, stateStrs, titleStr - The strings of the sketch.
+     Third Party Includes:
+       DS3231.h - Host model of the RTC library.
+     Local Includes:
+       BufferedLCD.h - The buffered LCD driver of the firmware.
+
+   (C) RW128k 2024
+*/
+
+#include <DS3231.h>
+
+#include "BufferedLCD.h"
+
+#if lcdParallel
+BufferedLCD lcd(ParallelBackend(6, 9, A1, A2, A3, 13, lcdRows));
+#else
+BufferedLCD lcd(PCF8574Backend(0x27, lcdCols, lcdRows));
+#endif
+DS3231 rtc(SDA, SCL);
+
+byte alarmMins;
+byte alarmHrs;
+byte alarmChallenge;
+byte alarmSnoozeSecs;
+byte alarmSnoozeMins;
+bool alarmState;
+byte brightness;
+
+Time timeObj;
+
+const char *dows[7] = {"Monday", "Tuesday", "Wednesday", "Thursday", "Friday", "Saturday", "Sunday"};
+const char *months[12] = {"January", "February", "March", "April", "May", "June", "July", "August", "September", "October", "November", "December"};
+const char *stateStrs[2] = {"OFF", "ON"};
+const char titleStr[13] = "FIRMWARE 3.0";
@@ -0,0 +1,258 @@
+/* TERALARM (FIRMWARE 3) - The effective alarm clock
+
+   testBufferedLCD.cpp - The tests of the buffered LCD, run on the host
+     against the framebuffer backend. Each test draws to the LCD and checks
+     the modelled display memory (what would be shown) and the instructions
+     and batches used to send it, including runs which end on the wraps of
+     display memory (0x27 -> 0x40 and 0x67 -> 0x00) where no address
+     instruction is needed, custom characters beyond the 8 slots and frames
+     sent a single batch at a time by service. The template methods of the
+     LCD are included from BufferedLCD.cpp so that it can be instantiated
+     with the test backend.
+     Usage: testBufferedLCD
+     External Variables / Constants: N/A
+     Third Party Includes:
+       Arduino.h - Host shim of the Arduino core.
+     Local Includes:
+       BufferedLCD.cpp - The buffered LCD driver of the firmware.
+       FramebufferBackend.h - Backend modelling the HD44780 memory.
+
+   (C) RW128k 2024
+*/
+
+#include <Arduino.h>
+
+#include "BufferedLCD.cpp"
+#include "FramebufferBackend.h"
+
+typedef BasicBufferedLCD<20, 4, FramebufferBackend> TestLCD;
+typedef BasicBufferedLCD<16, 2, FramebufferBackend> SmallTestLCD;
+
+// glyphs used by the tests, each row holding the glyph ID so the glyph in a
+// slot can be identified from its bitmap
+static const uint8_t glyph01[8] PROGMEM = {0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01};
+static const uint8_t glyph02[8] PROGMEM = {0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02};
+static const uint8_t glyph03[8] PROGMEM = {0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03};
+static const uint8_t glyph04[8] PROGMEM = {0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04};
+static const uint8_t glyph05[8] PROGMEM = {0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05, 0x05};
+static const uint8_t glyph06[8] PROGMEM = {0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06};
+static const uint8_t glyph07[8] PROGMEM = {0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07};
+static const uint8_t glyph10[8] PROGMEM = {0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10};
+static const uint8_t glyph11[8] PROGMEM = {0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11};
+static const uint8_t *const glyphs[32] PROGMEM = {
+  NULL, glyph01, glyph02, glyph03, glyph04, glyph05, glyph06, glyph07,
+  NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+  glyph10, glyph11, NULL, NULL, NULL, NULL, NULL, NULL,
+  NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL
+};
+
+static unsigned int failures = 0;
+
+static void check(bool condition, const char *test, const char *message) {
+  /* check - Function which reports a failed check of a test.
+       Parameters:
+         condition - Boolean which is true if the check passed.
+         test - The name of the test.
+         message - What was checked.
+       Returns: N/A
+  */
+
+  if (condition) {return;}
+  printf("FAIL %s: %s\n", test, message);
+  failures++;
+}
+
+template <class LCD>
+static bool shows(LCD &lcd, uint8_t x, uint8_t y, const char *text) {
+  /* shows - Function which checks the display shows a string from a
+       position, custom characters being identified by the slot they are
+       shown from.
+       Parameters:
+         lcd - The LCD under test.
+         x - A byte representing the column of the first character.
+         y - A byte representing the row.
+         text - The characters or glyph IDs expected.
+       Returns: Boolean which is true if the whole string is shown.
+  */
+
+  for (uint8_t i = 0; text[i] != '\0'; i++) {
+    uint8_t code = lcd.visible(x + i, y, lcd.maxX);
+    if (code >= 0x08 && code < 0x10) {code = lcd.cgram[(code - 0x08) * 8];}
+    if (code != uint8_t(text[i])) {return false;}
+  }
+  return true;
+}
+
+static void testRows() {
+  TestLCD lcd((FramebufferBackend()));
+  lcd.begin();
+  lcd.beginFrame();
+  for (uint8_t y = 0; y < 4; y++) {
+    lcd.setCursor(0, y);
+    lcd.print(F("ROW-"));
+    lcd.printUInt(y);
+  }
+  lcd.flush();
+
+  check(memcmp(lcd.ddram + 0x00, "ROW-0", 5) == 0, "rows", "row 0 at 0x00");
+  check(memcmp(lcd.ddram + 0x40, "ROW-1", 5) == 0, "rows", "row 1 at 0x40");
+  check(memcmp(lcd.ddram + 0x14, "ROW-2", 5) == 0, "rows", "row 2 at 0x14");
+  check(memcmp(lcd.ddram + 0x54, "ROW-3", 5) == 0, "rows", "row 3 at 0x54");
+  check(lcd.addressInstructions == 4, "rows", "one address instruction a row");
+
+  // a run continuing from the end of the last one needs no address
+  lcd.resetCounters();
+  lcd.setCursor(5, 3);
+  lcd.print(F("!"));
+  check(lcd.addressInstructions == 0, "rows", "no address for a run following on");
+  check(shows(lcd, 0, 3, "ROW-3!"), "rows", "run following on written in place");
+
+  // unchanged characters are not sent
+  lcd.resetCounters();
+  lcd.setCursor(0, 0);
+  lcd.print(F("ROW-0"));
+  check(lcd.transfers == 0, "rows", "nothing sent for unchanged characters");
+}
+
+static void testWraps() {
+  TestLCD lcd((FramebufferBackend()));
+  lcd.begin();
+
+  // a run to the end of row 2 leaves the controller at the start of row 1
+  lcd.setCursor(0, 2);
+  lcd.print(F("22222222222222222222"));
+  check(lcd.addressCounter == 0x40, "wraps", "row 2 ends at 0x40");
+  lcd.resetCounters();
+  lcd.setCursor(0, 1);
+  lcd.print(F("1"));
+  check(lcd.addressInstructions == 0, "wraps", "no address after 0x27 -> 0x40");
+  check(lcd.ddram[0x40] == '1' && shows(lcd, 0, 1, "1"), "wraps", "row 1 written after 0x27 -> 0x40");
+
+  // a run to the end of row 3 leaves the controller at the start of row 0
+  lcd.setCursor(0, 3);
+  lcd.print(F("33333333333333333333"));
+  check(lcd.addressCounter == 0x00, "wraps", "row 3 ends at 0x00");
+  lcd.resetCounters();
+  lcd.setCursor(0, 0);
+  lcd.print(F("0"));
+  check(lcd.addressInstructions == 0, "wraps", "no address after 0x67 -> 0x00");
+  check(lcd.ddram[0x00] == '0' && shows(lcd, 0, 0, "0"), "wraps", "row 0 written after 0x67 -> 0x00");
+
+  // a run ending mid row must not be taken to wrap
+  lcd.setCursor(0, 2);
+  lcd.print(F("2"));
+  lcd.resetCounters();
+  lcd.setCursor(0, 1);
+  lcd.print(F("x"));
+  check(lcd.addressInstructions == 1, "wraps", "address sent when no wrap");
+  check(shows(lcd, 0, 1, "x") && shows(lcd, 0, 2, "22222222222222222222"), "wraps", "rows 1 and 2 after no wrap");
+}
+
+static void testSmall() {
+  SmallTestLCD lcd((FramebufferBackend()));
+  lcd.begin();
+  lcd.beginFrame();
+  lcd.setCursor(0, 0);
+  lcd.print(F("0123456789ABCDEF"));
+  lcd.setCursor(0, 1);
+  lcd.print(F("FEDCBA9876543210"));
+  lcd.flush();
+
+  check(memcmp(lcd.ddram + 0x00, "0123456789ABCDEF", 16) == 0, "16x2", "row 0 at 0x00");
+  check(memcmp(lcd.ddram + 0x40, "FEDCBA9876543210", 16) == 0, "16x2", "row 1 at 0x40");
+
+  // the end of a 16 column row is not a wrap, so row 1 needs its address
+  check(lcd.addressCounter == 0x50, "16x2", "row 1 ends at 0x50");
+  lcd.setCursor(15, 0);
+  lcd.print('f');
+  lcd.resetCounters();
+  lcd.setCursor(0, 1);
+  lcd.print('x');
+  check(lcd.addressInstructions == 1, "16x2", "address sent after the end of row 0");
+  check(shows(lcd, 0, 1, "xEDCBA9876543210") && shows(lcd, 15, 0, "f"), "16x2", "rows after the end of row 0");
+}
+
+static void testGlyphs() {
+  TestLCD lcd((FramebufferBackend()));
+  lcd.begin();
+  lcd.setGlyphs(glyphs);
+
+  // 9 glyphs only fit 8 slots, so the last is shown as whitespace
+  lcd.setCursor(0, 0);
+  lcd.print("\1\2\3\4\5\6\7\x10\x11");
+  check(shows(lcd, 0, 0, "\1\2\3\4\5\6\7\x10 "), "glyphs", "8 glyphs shown and the 9th blank");
+
+  // while nothing changes no slot can free, so nothing is sent again
+  lcd.resetCounters();
+  lcd.flush();
+  lcd.service();
+  check(lcd.transfers == 0, "glyphs", "nothing sent while the 9th glyph has no slot");
+  check(shows(lcd, 0, 0, "\1\2\3\4\5\6\7\x10 "), "glyphs", "9th glyph still blank while nothing changes");
+
+  // once a glyph leaves the screen the blank one is retried
+  lcd.setCursor(0, 0);
+  lcd.print('A');
+  check(shows(lcd, 0, 0, "A\2\3\4\5\6\7\x10\x11"), "glyphs", "9th glyph shown when a slot frees");
+
+  // a glyph brought back replaces one no longer on screen
+  lcd.setCursor(0, 1);
+  lcd.print(F("B"));
+  lcd.setCursor(8, 0);
+  lcd.print("\1");
+  check(shows(lcd, 0, 0, "A\2\3\4\5\6\7\x10\1"), "glyphs", "glyph reloaded in place of one removed");
+}
+
+static void testService() {
+  TestLCD lcd((FramebufferBackend()));
+  lcd.begin();
+  lcd.setGlyphs(glyphs);
+
+  // compose a full screen with 8 glyphs needing uploads, then send it a
+  // batch at a time
+  lcd.beginFrame();
+  for (uint8_t y = 0; y < 4; y++) {
+    lcd.setCursor(0, y);
+    lcd.print(F("SERVICE"));
+    lcd.print("\1\2\3\4\5\6\7\x10");
+    lcd.print(F("LINE"));
+    lcd.printUInt(y);
+  }
+  lcd.flushLater();
+  check(lcd.transfers == 0, "service", "nothing sent by flushLater");
+
+  unsigned int calls = 0;
+  bool single = true;
+  for (; calls < 200 && !shows(lcd, 0, 3, "SERVICE\1\2\3\4\5\6\7\x10LINE3"); calls++) {
+    unsigned long transfers = lcd.transfers;
+    lcd.service();
+    if (lcd.transfers - transfers > 1) {single = false;}
+  }
+  check(single, "service", "at most one batch a call");
+  check(lcd.longestTransfer <= 6, "service", "batches within their length");
+  for (uint8_t y = 0; y < 4; y++) {
+    char line[21];
+    snprintf(line, sizeof(line), "SERVICE\1\2\3\4\5\6\7\x10LINE%u", y);
+    check(shows(lcd, 0, y, line), "service", "whole screen sent");
+  }
+
+  // nothing more is sent once the screen is complete
+  unsigned long transfers = lcd.transfers;
+  lcd.service();
+  check(lcd.transfers == transfers, "service", "nothing sent when complete");
+  printf("service: full screen with 8 glyph uploads sent in %u calls\n", calls);
+}
+
+int main() {
+  testRows();
+  testWraps();
+  testSmall();
+  testGlyphs();
+  testService();
+
+  if (failures != 0) {
+    printf("%u checks failed\n", failures);
+    return 1;
+  }
+  printf("all buffered LCD tests passed\n");
+  return 0;
+}
@@ -0,0 +1,362 @@
+/* TERALARM (FIRMWARE 3) - The effective alarm clock
+
+   walkScreens.cpp - The walkthrough which runs the sketch itself (setup and
+     loop) on the host and prints every screen it draws, for checking the
+     layouts of each LCD size by eye. The LCD is a model of the HD44780 on
+     its I2C backpack, so the screens are what the hardware would show,
+     custom characters included. A script of button presses, waits for text
+     to be shown and screen captures is run from the clock hook, so it acts
+     while the firmware waits in its menus, and fails if the text it waits
+     for is never shown. It covers the boot animation, clockface, brightness
+     screen, debug mode, every editor with its confirmation and
+     cancellation, the alarm with a wrong and a right answer and the snooze
+     countdown and alert. The RTC model is ticked every second of virtual
+     time. With timer, all buttons are held during boot to show the secret
+     countdown timer instead, which never returns, so the walkthrough exits
+     from the script. When built with lcdParallel the model is fed from the
+     LCD pins instead of the backpack, sampled whenever the clock moves.
+     Usage: walkScreens [timer]
+     External Variables / Constants: N/A
+     Third Party Includes:
+       Arduino.h - Host shim of the Arduino core.
+       Wire.h - Host model of the I2C bus.
+       DS3231.h - Host model of the RTC.
+       EEPROM.h - Host model of the EEPROM, preset with the settings.
+     Local Includes:
+       BackpackModel.h - Model of the LCD on its I2C backpack.
+       teralarm.ino - The sketch, in place of the globals of the harness.
+
+   (C) RW128k 2024
+*/
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <DS3231.h>
+#include <EEPROM.h>
+
+#include "BackpackModel.h"
+#include "teralarm.ino"
+
+// actions of the script
+#define actPress 'p'
+#define actHold 'h'
+#define actRelease 'r'
+#define actWait 'w'
+#define actAnswer 'a'
+#define actShow 's'
+#define actQuit 'q'
+
+// length of a scripted button press (ms) and the virtual time after which
+// the walkthrough is taken to be stuck (us)
+#define pressLength 150
+#define stuckMicros 600000000UL
+
+// time the LCD pins must be idle before the script acts when the LCD is wired
+// directly, so a screen is not read while it is part sent (us)
+#define settleMicros 500
+
+// text shown on the clockface (and the debug mode) only, the degree symbol
+#define degrees "\xDF" "C"
+
+struct Step {
+  unsigned long ms;
+  char action;
+  byte button;
+  const char *text;
+};
+
+// the walkthrough of the brightness screen, the debug mode, the menus and
+// the alarm (set for 00:02 with a challenge of 2 and 5 seconds of snooze).
+// each step is taken the given time after the last, waits also holding the
+// script until their text is shown
+static const Step walkSteps[] = {
+  {0, actWait, 0, "FIRMWARE 3.0"},
+  {0, actShow, 0, "boot title"},
+  {0, actWait, 0, "-RWGUNN '22-"},
+  {0, actShow, 0, "boot credits"},
+  {0, actWait, 0, degrees},
+  {1000, actShow, 0, "clockface"},
+  // brightness up, down and to auto, then hold buttons 1 and 2 into debug
+  // mode and show each item of its carousel
+  {0, actPress, 3, NULL},
+  {500, actShow, 0, "brightness (up)"},
+  {0, actPress, 4, NULL},
+  {300, actPress, 4, NULL},
+  {300, actPress, 4, NULL},
+  {500, actShow, 0, "brightness (down)"},
+  {0, actPress, 4, NULL},
+  {300, actPress, 4, NULL},
+  {300, actPress, 4, NULL},
+  {300, actPress, 4, NULL},
+  {300, actPress, 4, NULL},
+  {300, actPress, 4, NULL},
+  {300, actPress, 4, NULL},
+  {500, actShow, 0, "brightness (auto)"},
+  {0, actHold, 1, NULL},
+  {0, actHold, 2, NULL},
+  {0, actWait, 0, "DEBUG MODE"},
+  {0, actRelease, 0, NULL},
+  {500, actShow, 0, "debug"},
+  {2000, actShow, 0, "debug"},
+  {2000, actShow, 0, "debug"},
+  {2000, actShow, 0, "debug"},
+  {2000, actShow, 0, "debug"},
+  {2000, actShow, 0, "debug"},
+  {2000, actShow, 0, "debug"},
+  {2000, actShow, 0, "debug"},
+  {2000, actShow, 0, "debug"},
+  {2000, actShow, 0, "debug"},
+  {2000, actShow, 0, "debug"},
+  {2000, actShow, 0, "debug"},
+  {0, actPress, 1, NULL},
+  // button 1: set the time, date and weekday, confirming each unchanged
+  {0, actWait, 0, degrees},
+  {1000, actPress, 1, NULL},
+  {0, actWait, 0, "SET TIME:"},
+  {0, actShow, 0, "set time"},
+  {500, actPress, 1, NULL},
+  {500, actPress, 1, NULL},
+  {0, actWait, 0, "TIME SET TO:"},
+  {0, actShow, 0, "time set"},
+  {0, actWait, 0, "SET DATE:"},
+  {0, actShow, 0, "set date"},
+  {500, actPress, 1, NULL},
+  {500, actPress, 1, NULL},
+  {500, actPress, 1, NULL},
+  {0, actWait, 0, "DATE SET TO:"},
+  {0, actShow, 0, "date set"},
+  {0, actWait, 0, "SET WEEKDAY:"},
+  {0, actShow, 0, "set weekday"},
+  {500, actPress, 1, NULL},
+  {0, actWait, 0, "WEEKDAY SET TO:"},
+  {0, actShow, 0, "weekday set"},
+  // button 2: the alarm settings, changing the state and cancelling it
+  {0, actWait, 0, degrees},
+  {1000, actPress, 2, NULL},
+  {0, actWait, 0, "SET ALARM:"},
+  {0, actShow, 0, "set alarm"},
+  {500, actPress, 1, NULL},
+  {500, actPress, 1, NULL},
+  {0, actWait, 0, "ALARM SET TO:"},
+  {0, actShow, 0, "alarm set"},
+  {0, actWait, 0, "SET CHALLENGE:"},
+  {0, actShow, 0, "set challenge"},
+  {500, actPress, 1, NULL},
+  {0, actWait, 0, "CHALLENGE SET"},
+  {0, actShow, 0, "challenge set"},
+  {0, actWait, 0, "SET SNOOZE:"},
+  {0, actShow, 0, "set snooze"},
+  {500, actPress, 1, NULL},
+  {500, actPress, 1, NULL},
+  {0, actWait, 0, "SNOOZE SET TO:"},
+  {0, actShow, 0, "snooze set"},
+  {0, actWait, 0, "SET STATE:"},
+  {0, actShow, 0, "set state"},
+  {500, actPress, 3, NULL},
+  {500, actShow, 0, "set state (changed)"},
+  {0, actPress, 2, NULL},
+  {0, actWait, 0, "CANCELLED!"},
+  {0, actShow, 0, "cancelled"},
+  // the alarm, answered wrongly then rightly twice, then the snooze
+  {0, actWait, 0, "ALARM!"},
+  {0, actShow, 0, "alarm"},
+  {500, actAnswer, 0, "wrong"},
+  {0, actWait, 0, "INCORRECT!"},
+  {0, actShow, 0, "incorrect"},
+  {0, actWait, 0, "ENTER: "},
+  {500, actAnswer, 0, NULL},
+  {0, actWait, 0, " CORRECT!"},
+  {0, actShow, 0, "correct"},
+  {0, actWait, 0, "ENTER: "},
+  {500, actShow, 0, "alarm (second question)"},
+  {0, actAnswer, 0, NULL},
+  {0, actWait, 0, "ALARM DISABLED!"},
+  {0, actShow, 0, "alarm disabled"},
+  {0, actWait, 0, "SNOOZING"},
+  {2000, actShow, 0, "snooze countdown"},
+  {0, actWait, 0, "SNOOZE ELAPSED"},
+  {0, actWait, 0, "PRESS ANY BUTTON"},
+  {0, actShow, 0, "snooze elapsed"},
+  {0, actPress, 1, NULL},
+  {0, actWait, 0, "DISMISSED!"},
+  {0, actShow, 0, "dismissed"},
+  {0, actWait, 0, degrees},
+  {1000, actShow, 0, "clockface"},
+  {0, actQuit, 0, NULL}
+};
+
+// the secret countdown timer, entered by holding all buttons during boot
+static const Step timerSteps[] = {
+  {0, actHold, 1, NULL},
+  {0, actHold, 2, NULL},
+  {0, actHold, 3, NULL},
+  {0, actHold, 4, NULL},
+  {0, actWait, 0, "100 SECOND"},
+  {0, actRelease, 0, NULL},
+  {0, actWait, 0, "PRESS ANY BUTTON"},
+  {0, actShow, 0, "secret timer"},
+  {3000, actShow, 0, "secret timer"},
+  {0, actPress, 1, NULL},
+  {10000, actShow, 0, "secret timer (running)"},
+  {100000, actShow, 0, "secret timer (ended)"},
+  {0, actQuit, 0, NULL}
+};
+
+static BackpackModel *model;
+static const Step *steps;
+static unsigned int stepCount;
+static unsigned int nextStep = 0;
+static unsigned long stepMicros = 0;
+static unsigned long nextTick = 1000000;
+static unsigned long releaseAt = 0;
+static byte releasePin = 0;
+static unsigned long latchMicros = 0;
+
+static void pressButton(byte button) {
+  hostPins[button1 + button - 1] = LOW;
+  releasePin = button1 + button - 1;
+  releaseAt = hostMicros + pressLength * 1000UL;
+}
+
+#if lcdParallel
+static void samplePins() {
+  /* samplePins - Function which latches the nibble on the LCD data pins into
+       the model while the enable pin is high. The parallel backend holds
+       enable high across a single 1us delay for each pulse, so each pulse is
+       sampled exactly once by the clock hook.
+       Parameters: N/A
+       Returns: N/A
+  */
+
+  if ((hostPorts[lcdEnable] & digitalPinToBitMask(lcdEnable)) == 0) {return;}
+
+  const byte pins[4] = {lcdD4, lcdD5, lcdD6, lcdD7};
+  byte nibble = 0;
+  for (byte i = 0; i < 4; i++) {
+    if (hostPorts[pins[i]] & digitalPinToBitMask(pins[i])) {nibble |= 0x10 << i;}
+  }
+  model->latch(nibble, hostPorts[lcdRS] & digitalPinToBitMask(lcdRS));
+  latchMicros = hostMicros;
+}
+#endif
+
+static bool shown(const char *text) {
+  /* shown - Function which checks if a text is shown on any line of the LCD.
+       Parameters:
+         text - The text to look for.
+       Returns: Boolean which is true if the text is shown.
+  */
+
+  for (byte y = 0; y < lcdRows; y++) {
+    char line[41];
+    model->line(y, line);
+    if (strstr(line, text) != NULL) {return true;}
+  }
+  return false;
+}
+
+static void answer(bool right) {
+  /* answer - Function which presses the button the alarm challenge asks for,
+       read from the bottom line of the LCD, or the next button if the answer
+       is to be wrong.
+       Parameters:
+         right - Boolean which is true to answer rightly.
+       Returns: N/A
+  */
+
+  char line[41];
+  model->line(alarmChallengeY, line);
+  const char *question = strstr(line, "ENTER: ");
+  if (question == NULL) {return;}
+  byte button = question[7] - '0';
+  pressButton(right ? button : button % 4 + 1);
+}
+
+static void runScript() {
+  /* runScript - Function run whenever the virtual clock moves, which feeds
+       the LCD pins to the model (if wired directly), ticks the RTC model each
+       second, ends scripted presses and carries out the steps of the script
+       which have become due (once a directly wired LCD has finished sending).
+       Parameters: N/A
+       Returns: N/A
+  */
+
+  #if lcdParallel
+  samplePins();
+  #endif
+  while (hostMicros >= nextTick) {
+    hostRtc.tick();
+    nextTick += 1000000;
+  }
+  if (releaseAt != 0 && hostMicros >= releaseAt) {
+    hostPins[releasePin] = HIGH;
+    releaseAt = 0;
+  }
+
+  // wait for a directly wired LCD to finish sending the screen
+  if (lcdParallel && hostMicros - latchMicros < settleMicros) {return;}
+
+  while (nextStep < stepCount && hostMicros >= stepMicros + steps[nextStep].ms * 1000UL) {
+    const Step &step = steps[nextStep];
+    if (step.action == actWait && !shown(step.text)) {
+      if (hostMicros < stuckMicros) {return;}
+      printf("FAIL stuck waiting for \"%s\"\n", step.text);
+      model->print(stdout);
+      exit(1);
+    }
+    nextStep++;
+    stepMicros = hostMicros;
+
+    switch (step.action) {
+      case actPress: {
+        pressButton(step.button);
+        break;
+      } case actHold: {
+        hostPins[button1 + step.button - 1] = LOW;
+        break;
+      } case actRelease: {
+        for (byte pin = button1; pin <= button4; pin++) {hostPins[pin] = HIGH;}
+        break;
+      } case actAnswer: {
+        answer(step.text == NULL);
+        break;
+      } case actShow: {
+        printf("%s (%lu.%lus)\n", step.text, hostMicros / 1000000, hostMicros / 100000 % 10);
+        model->print(stdout);
+        break;
+      } case actQuit: {
+        exit(0);
+      }
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  bool timer = argc > 1 && strcmp(argv[1], "timer") == 0;
+  steps = timer ? timerSteps : walkSteps;
+  stepCount = timer ? sizeof(timerSteps) / sizeof(Step) : sizeof(walkSteps) / sizeof(Step);
+
+  // preset the settings: alarm on at 00:02 with a challenge of 2 and 5
+  // seconds of snooze, manual brightness
+  EEPROM.write(0, 0);
+  EEPROM.write(1, 2);
+  EEPROM.write(2, 2);
+  EEPROM.write(3, 0);
+  EEPROM.write(4, 5);
+  EEPROM.write(5, 1);
+  EEPROM.write(6, 9);
+
+  BackpackModel backpack(lcdCols, lcdRows);
+  model = &backpack;
+  #if lcdParallel
+  printf("walkthrough of the screens on a %ux%u LCD wired directly\n", lcdCols, lcdRows);
+  #else
+  Wire.attach(0x27, &backpack);
+  printf("walkthrough of the screens on a %ux%u LCD\n", lcdCols, lcdRows);
+  #endif
+
+  // run the sketch, the script ending the walkthrough
+  hostClockHook = runScript;
+  setup();
+  while (true) {loop();}
+}
@@ -0,0 +1,86 @@
+#!/usr/bin/env python3
+"""TERALARM (FIRMWARE 3) - The effective alarm clock
+
+   lcdMirror.py - Host side decoder for the LCD mirror streamed over Serial
+     when lcdMirror is set in BufferedLCD.h. Reconstructs the screen from the
+     frames of changed runs and redraws it in the terminal after each frame.
+     Each frame is the marker 0xFE, a position byte holding the row in the
+     upper 3 bits and the column in the lower 5, a length byte and then the
+     characters of the run. Any other bytes (eg the startup banner) are
+     ignored, and frames with an impossible position or length are skipped
+     so the decoder resynchronises on the next marker. Custom characters
+     arrive as their glyph IDs and are shown as similar looking characters.
+     Requires pyserial when reading from a serial port.
+     Usage: lcdMirror.py PORT [--baud 9600] [--cols 20] [--rows 4]
+            lcdMirror.py - < capture.bin
+
+   (C) RW128k 2024
+"""
+
+import argparse
+import sys
+
+MARKER = 0xFE
+
+# terminal characters shown for glyph IDs (see customGlyphs.cpp) and the
+# HD44780 degree symbol
+GLYPHS = {
+    0x01: "█", 0x02: "▐", 0x03: "▬", 0x04: "▌",
+    0x10: "▔", 0x11: "▁", 0x12: "▏", 0x13: "▕",
+    0x14: "┌", 0x15: "┐", 0x16: "└", 0x17: "┘",
+    0xDF: "°",
+}
+
+
+def decode(stream, cols, rows):
+    """Yield the screen as a list of rows after each frame in the stream."""
+    screen = [[" "] * cols for _ in range(rows)]
+    while True:
+        # skip to the next frame marker
+        byte = stream.read(1)
+        if not byte:
+            return
+        if byte[0] != MARKER:
+            continue
+
+        # read the header, dropping frames which cannot fit on the screen
+        header = stream.read(2)
+        if len(header) < 2:
+            return
+        row, col, length = header[0] >> 5, header[0] & 0x1F, header[1]
+        if row >= rows or length == 0 or col + length > cols:
+            continue
+
+        # copy the run into the screen
+        run = stream.read(length)
+        if len(run) < length:
+            return
+        for i, code in enumerate(run):
+            screen[row][col + i] = GLYPHS.get(code, chr(code) if 0x20 <= code < 0x7F else "?")
+        yield ["".join(line) for line in screen]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Show the TERALARM LCD mirrored over Serial.")
+    parser.add_argument("port", help="serial port, or - to read a capture from stdin")
+    parser.add_argument("--baud", type=int, default=9600)
+    parser.add_argument("--cols", type=int, default=20)
+    parser.add_argument("--rows", type=int, default=4)
+    args = parser.parse_args()
+
+    if args.port == "-":
+        stream = sys.stdin.buffer
+    else:
+        import serial
+        stream = serial.Serial(args.port, args.baud)
+
+    # redraw the screen in place inside a border after each frame
+    for screen in decode(stream, args.cols, args.rows):
+        out = ["\x1b[H\x1b[2J+" + "-" * args.cols + "+"]
+        out += ["|" + line + "|" for line in screen]
+        out.append("+" + "-" * args.cols + "+")
+        print("\n".join(out), flush=True)
+
+
+if __name__ == "__main__":
+    main()